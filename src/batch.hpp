@@ -0,0 +1,228 @@
+// Batch solving of many independent sssp instances on a pool of threads.
+// Throughput-oriented: every query runs single-threaded, and worker threads
+// pull the next query from a shared counter until the batch is drained.
+#pragma once
+
+#include "config.hpp"
+#include "sssp.hpp"
+#include "workspace.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+struct BatchOptions {
+    size_t num_threads = 1;        // worker threads, including the calling one
+    size_t budget = size_t(-1);    // capper budget per query, size_t(-1) for none
+    size_t seed = 0x5174;          // query i draws from seed_seq({seed, i})
+
+    // forwarded to the SSSPConfig of every query
+    ValidationPolicy validation;
+    NonNegativeEngine engine = ENGINE_DIJKSTRA;
+    bool cache_reduced_weights = false;
+    VertexOrder vertex_order = ORDER_NONE;
+    Decomposition decomposition = DECOMPOSE_BALLS;
+    bool prune_unreachable = false;
+    bool simplify_multigraph = false;
+    bool narrow_weights = false;
+    bool split_sccs_first = false;
+};
+
+namespace internal {
+    // batch_config makes the SSSPConfig of one query of a batch.
+    inline SSSPConfig batch_config(const BatchOptions &opt, OperationCapper *capper, mt19937_64 rng) {
+        SSSPConfig cfg(capper, rng);
+        cfg.validation = opt.validation;
+        cfg.engine = opt.engine;
+        cfg.cache_reduced_weights = opt.cache_reduced_weights;
+        cfg.vertex_order = opt.vertex_order;
+        cfg.decomposition = opt.decomposition;
+        cfg.prune_unreachable = opt.prune_unreachable;
+        cfg.simplify_multigraph = opt.simplify_multigraph;
+        cfg.narrow_weights = opt.narrow_weights;
+        cfg.split_sccs_first = opt.split_sccs_first;
+        return cfg;
+    }
+
+    // run_batch calls solve(i, cfg, ws) for every i in [0, q) on opt.num_threads workers,
+    // and returns the witnesses in order of i. Each query has its own capper and RNG
+    // stream, and each worker its own Workspace, so results do not depend on scheduling.
+    template <typename T, typename I, typename Solver>
+    vector<Witness<T, I>> run_batch(
+        size_t q,
+        const BatchOptions &opt,
+        Solver solve
+    ) {
+        vector<Witness<T, I>> results(q);
+        atomic<size_t> next(0);
+
+        auto worker = [&]() {
+            Workspace<T, I> ws;
+            for(size_t i = next.fetch_add(1); i < q; i = next.fetch_add(1)) {
+                NoCapOperationCapper no_cap;
+                NormalOperationCapper cap(opt.budget);
+                seed_seq seq({opt.seed, i});
+                mt19937_64 rng(seq);
+
+                auto cfg = batch_config(opt, opt.budget == size_t(-1) ? (OperationCapper *) &no_cap : &cap, rng);
+
+                results[i] = solve(i, cfg, ws);
+            }
+        };
+
+        vector<thread> workers;
+        for(size_t t = 1; t < min(max<size_t>(1, opt.num_threads), q); t++) workers.emplace_back(worker);
+        worker();
+        for(auto &w : workers) w.join();
+
+        return results;
+    }
+}
+
+// sssp_batch solves sssp(graphs[i], sources[i]) for every i, and returns the
+// witnesses in input order. See internal::run_batch.
+template <typename T, typename I>
+vector<Witness<T, I>> sssp_batch(
+    vector<Graph<T, I>> &graphs,
+    const vector<size_t> &sources,
+    const BatchOptions &opt = BatchOptions()
+) {
+    assert(graphs.size() == sources.size());
+
+    return internal::run_batch<T, I>(graphs.size(), opt, [&](size_t i, SSSPConfig &cfg, Workspace<T, I> &ws) {
+        return sssp(graphs[i], sources[i], cfg, &ws);
+    });
+}
+
+// sssp_batch solves sssp(g, sources[i]) for every i, in input order.
+// g is only read; it must not change until the batch returns.
+template <typename T, typename I>
+vector<Witness<T, I>> sssp_batch(
+    Graph<T, I> &g,
+    const vector<size_t> &sources,
+    const BatchOptions &opt = BatchOptions()
+) {
+    // the workers share g: fill its reduced weight cache now, so that they only read it.
+    if(g.cache_reduced_weights) g.reduced_weights(opt.num_threads);
+
+    return internal::run_batch<T, I>(sources.size(), opt, [&](size_t i, SSSPConfig &cfg, Workspace<T, I> &ws) {
+        return sssp(g, sources[i], cfg, &ws);
+    });
+}
+
+// DistanceBlock holds the distances from k sources to all n vertices, row-major.
+// Each row is padded to whole cache lines. An entry holds distance >> shift
+// (rounded down) as a D. numeric_limits<D>::max() means unreachable; distances
+// that do not fit in D saturate to D's range, so pick D and shift for the weights.
+template <typename T, typename D = T>
+struct DistanceBlock {
+    ShortestPathState state = UNKNOWN;
+    size_t k = 0, n = 0;
+    size_t stride = 0; // entries per row
+    unsigned shift = 0;
+    vector<D> data;
+    NegativeCycleWitness negative_cycle_witness;
+
+    const D *row(size_t i) const { return data.data() + i * stride; }
+
+    // distance from source i to v, rounded down to a multiple of 2^shift.
+    T at(size_t i, size_t v) const {
+        D x = row(i)[v];
+        if(x == numeric_limits<D>::max()) return numeric_limits<T>::max();
+        return T(x) * (T(1) << shift);
+    }
+};
+
+// distance_block computes the distances from every source to every vertex of g.
+// sssp() would repeat the scaling phase per source; here the potential is found once
+// (nonnegative_reweighting, with opt.budget and opt.seed), and then one dijkstra per
+// source runs on opt.num_threads workers, as in sssp_batch. The dijkstras run on
+// non-negative reduced weights and are exact, so rows are not validated one by one.
+// shift: quantization, see DistanceBlock.
+// trees: if given, receives the shortest path tree of every source on g (with pure_dist).
+// Negative cycles and an exhausted budget are reported in the state of the block.
+template <typename T, typename I, typename D = T>
+DistanceBlock<T, D> distance_block(
+    Graph<T, I> &g,
+    const vector<size_t> &sources,
+    const BatchOptions &opt = BatchOptions(),
+    unsigned shift = 0,
+    vector<Witness<T, I>> *trees = nullptr
+) {
+    DistanceBlock<T, D> ret;
+    size_t n = g.N(), k = sources.size();
+    const T INF = numeric_limits<T>::max();
+
+    // the potential does not depend on the source.
+    Graph<T, I> h(0);
+    {
+        NoCapOperationCapper no_cap;
+        NormalOperationCapper cap(opt.budget);
+        auto cfg = internal::batch_config(opt, opt.budget == size_t(-1) ? (OperationCapper *) &no_cap : &cap, mt19937_64(opt.seed));
+        cfg.num_threads = opt.num_threads;
+
+        auto wit = nonnegative_reweighting(g, h, cfg);
+        if(wit.state != SHORTEST_PATH_TREE_FOUND) {
+            ret.state = wit.state;
+            ret.negative_cycle_witness = wit.negative_cycle_witness;
+            return ret;
+        }
+    }
+
+    // the workers share h: fill its reduced weight cache now, so that they only read it.
+    if(h.cache_reduced_weights) h.reduced_weights(opt.num_threads);
+
+    const size_t line = max<size_t>(1, 64 / sizeof(D));
+    ret.k = k;
+    ret.n = n;
+    ret.stride = (n + line - 1) / line * line;
+    ret.shift = shift;
+    ret.data.assign(k * ret.stride, numeric_limits<D>::max());
+
+    auto results = internal::run_batch<T, I>(k, opt, [&](size_t i, SSSPConfig &cfg, Workspace<T, I> &ws) {
+        naive_dijkstra::multi_source_sparse(h, vector<size_t>({sources[i]}), true, ws, cfg.capper);
+        if(cfg.capper -> fail()) return Witness<T, I>();
+
+        // distances on g: walk up each reached vertex to the nearest one already known.
+        vector<T> pure(n, INF);
+        vector<size_t> path;
+        pure[sources[i]] = T(0);
+        for(auto v : ws.touched) {
+            size_t x = v;
+            while(pure[x] == INF) {
+                path.emplace_back(x);
+                x = h.edges[ws.parent_edge_idx.get(x)].s;
+            }
+            for(auto it = path.rbegin(); it != path.rend(); ++it) {
+                size_t edge_idx = ws.parent_edge_idx.get(*it);
+                pure[*it] = pure[g.edges[edge_idx].s] + g.weight(edge_idx);
+            }
+            path.clear();
+        }
+
+        D *out = ret.data.data() + i * ret.stride;
+        for(auto v : ws.touched) {
+            T q = pure[v] >> shift;
+            if constexpr(sizeof(D) < sizeof(T)) {
+                q = min(max(q, T(numeric_limits<D>::lowest())), T(numeric_limits<D>::max() - 1));
+            }
+            out[v] = D(q);
+        }
+
+        Witness<T, I> wit;
+        wit.state = SHORTEST_PATH_TREE_FOUND;
+        if(trees != nullptr) {
+            wit.shortest_path_tree_witness = ws.witness(n);
+            tree_distances(g, wit.shortest_path_tree_witness);
+            wit.shortest_path_tree_witness.pure_dist = move(pure);
+        }
+        return wit;
+    });
+
+    ret.state = SHORTEST_PATH_TREE_FOUND;
+    for(auto &wit : results) {
+        if(wit.state != SHORTEST_PATH_TREE_FOUND) ret.state = UNKNOWN;
+    }
+    if(trees != nullptr) *trees = move(results);
+    return ret;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "batch.hpp"
+#include "catch2/catch_all.hpp"
+
+// random graph without negative cycles: backward edges outweigh any forward path.
+Graph<int> gen_forward_negative(size_t n, size_t m, size_t seed) {
+    Graph<int> g(n);
+    mt19937 rng(seed);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(-50, 20);
+
+    for(size_t i = 0; i < m; i++) {
+        size_t a = v(rng), b = v(rng);
+        while(a == b) b = v(rng);
+        int w = wt(rng);
+        if(a > b) w = abs(w) + 50 * int(n);
+        g.add_edge(Edge<int>({a, b, w}));
+    }
+
+    return g;
+}
+
+TEST_CASE("batch results are in input order", "[batch]") {
+    vector<Graph<int>> graphs;
+    vector<size_t> sources;
+    for(size_t i = 0; i < 12; i++) {
+        graphs.emplace_back(gen_forward_negative(15 + i, 30 + 2 * i, 0x900 + i));
+        sources.emplace_back(i % 5);
+    }
+
+    BatchOptions opt;
+    opt.num_threads = 4;
+    opt.budget = 200000;
+
+    auto results = sssp_batch(graphs, sources, opt);
+    REQUIRE( results.size() == graphs.size() );
+
+    for(size_t i = 0; i < graphs.size(); i++) {
+        auto bf = bellman_ford::single_source(graphs[i], sources[i]);
+        REQUIRE( results[i].state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( results[i].validate(graphs[i]) );
+        REQUIRE( results[i].shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+
+    // same answers on one thread.
+    opt.num_threads = 1;
+    auto sequential = sssp_batch(graphs, sources, opt);
+    for(size_t i = 0; i < graphs.size(); i++) {
+        REQUIRE( sequential[i].shortest_path_tree_witness.pure_dist == results[i].shortest_path_tree_witness.pure_dist );
+    }
+}
+
+TEST_CASE("batch of sources on one graph", "[batch]") {
+    Graph<int> g = gen_forward_negative(20, 50, 0x77);
+
+    BatchOptions opt;
+    opt.num_threads = 3;
+
+    vector<size_t> sources({4, 0, 4, 19, 7});
+    auto results = sssp_batch(g, sources, opt);
+
+    for(size_t i = 0; i < sources.size(); i++) {
+        REQUIRE( results[i].state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( results[i].shortest_path_tree_witness.pure_dist == bellman_ford::single_source(g, sources[i]).dist );
+    }
+
+    // a weight update is visible to the next batch.
+    g.set_weight(0, -1000);
+    auto updated = sssp_batch(g, vector<size_t>({g.edges[0].s}), opt);
+    REQUIRE( updated[0].state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( updated[0].shortest_path_tree_witness.pure_dist[g.edges[0].e] <= -1000 );
+}
+
+TEST_CASE("distance block from many sources", "[batch]") {
+    Graph<int> g = gen_forward_negative(40, 120, 0xd157);
+
+    BatchOptions opt;
+    opt.num_threads = 4;
+
+    vector<size_t> sources({0, 39, 7, 7, 21, 3});
+    vector<Witness<int>> trees;
+    auto block = distance_block(g, sources, opt, 0, &trees);
+
+    REQUIRE( block.state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( block.stride >= block.n );
+    REQUIRE( block.stride * sizeof(int) % 64 == 0 );
+    REQUIRE( trees.size() == sources.size() );
+
+    for(size_t i = 0; i < sources.size(); i++) {
+        auto bf = bellman_ford::single_source(g, sources[i]);
+        for(size_t v = 0; v < g.N(); v++) REQUIRE( block.at(i, v) == bf.dist[v] );
+
+        REQUIRE( trees[i].validate(g) );
+        REQUIRE( trees[i].shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+
+    SECTION("quantized") {
+        auto small = distance_block<int, size_t, int16_t>(g, sources, opt, 2);
+        REQUIRE( small.state == SHORTEST_PATH_TREE_FOUND );
+        for(size_t i = 0; i < sources.size(); i++) {
+            for(size_t v = 0; v < g.N(); v++) {
+                int d = block.at(i, v);
+                if(d == numeric_limits<int>::max()) REQUIRE( small.at(i, v) == d );
+                else REQUIRE( small.at(i, v) == (d >> 2) * 4 );
+            }
+        }
+    }
+
+    SECTION("cached reduced weights shared by the workers") {
+        opt.cache_reduced_weights = true;
+        g.cache_reduced_weights = true;
+        vector<size_t> all(g.N());
+        iota(all.begin(), all.end(), 0);
+
+        auto cached = distance_block(g, all, opt);
+        REQUIRE( cached.state == SHORTEST_PATH_TREE_FOUND );
+        auto results = sssp_batch(g, all, opt);
+        for(size_t i = 0; i < all.size(); i++) {
+            auto bf = bellman_ford::single_source(g, all[i]);
+            for(size_t v = 0; v < g.N(); v++) REQUIRE( cached.at(i, v) == bf.dist[v] );
+            REQUIRE( results[i].shortest_path_tree_witness.pure_dist == bf.dist );
+        }
+    }
+
+    SECTION("negative cycle") {
+        g.add_edge(Edge<int>({0, 39, -5}));
+        g.add_edge(Edge<int>({39, 0, -5}));
+        auto bad = distance_block(g, sources, opt);
+        REQUIRE( bad.state == NEGATIVE_CYCLE_FOUND );
+        REQUIRE( validate_negative_cycle(g, bad.negative_cycle_witness) );
+    }
+}
\ No newline at end of file
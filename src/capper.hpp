@@ -1,6 +1,7 @@
 // BCF23 depends on various 'terminate if does not work on time budget'.
 // Here we replace wall clock with operation count.
 #pragma once
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 
@@ -36,4 +37,16 @@ struct NormalOperationCapper : OperationCapper {
         if(!ret) cerr << "!!!Capper failed!!!\n";
         return ret;
     }
+};
+
+// NormalOperationCapper that also fails as soon as *cancelled is set,
+// e.g. by another thread that already found an answer.
+struct CancellableOperationCapper : NormalOperationCapper {
+    const atomic<bool> *cancelled;
+    CancellableOperationCapper(size_t budget, const atomic<bool> *cancelled) : NormalOperationCapper(budget), cancelled(cancelled) {}
+
+    bool incr(size_t amount = 1) override {
+        if(cancelled != nullptr && cancelled -> load(memory_order_relaxed)) return false;
+        return NormalOperationCapper::incr(amount);
+    }
 };
\ No newline at end of file
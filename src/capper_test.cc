@@ -10,4 +10,14 @@ TEST_CASE("verify capper", "[capper]") {
     REQUIRE( c.incr(3) ); // 2 <= 5, counter <- 5
     REQUIRE( c.incr(4) ); // 5 <= 5, counter <- 9
     REQUIRE_FALSE( c.incr() );
+}
+
+TEST_CASE("cancellable capper", "[capper]") {
+    atomic<bool> cancelled(false);
+    CancellableOperationCapper c(5, &cancelled);
+
+    REQUIRE( c.incr(2) );
+    cancelled = true;
+    REQUIRE_FALSE( c.incr() );
+    REQUIRE( c.counter == 2 );
 }
\ No newline at end of file
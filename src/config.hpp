@@ -5,10 +5,64 @@
 
 using namespace std;
 
+// ValidationMode decides how much of a witness is checked before it is trusted.
+enum ValidationMode {
+    VALIDATE_FULL,          // linear-time check of the whole tree and every edge
+    VALIDATE_SPOT_CHECK,    // check a few random vertices and edges only
+    VALIDATE_NONE           // trust the witness state
+};
+
+// ValidationPolicy chooses a ValidationMode per recursion level of rsssp.
+// Inner levels are re-checked by the top level anyway, so a wrong inner witness
+// can at worst turn the result into UNKNOWN, never into a wrong answer.
+struct ValidationPolicy {
+    ValidationMode top_level = VALIDATE_FULL;
+    ValidationMode inner_level = VALIDATE_SPOT_CHECK;
+    size_t spot_check_samples = 64;
+    mt19937_64 rng{0x7a11d}; // separate stream, so validation does not perturb the solver
+};
+
+// NonNegativeEngine selects the solver for the last phase of sssp(),
+// once the potential has made every reduced weight non-negative.
+enum NonNegativeEngine {
+    ENGINE_DIJKSTRA,
+    ENGINE_DELTA_STEPPING   // multithreaded, uses num_threads
+};
+
+// VertexOrder selects how sssp() relabels vertices before solving (see reorder.hpp).
+enum VertexOrder {
+    ORDER_NONE,     // keep input order
+    ORDER_BFS,      // breadth-first order over the undirected graph
+    ORDER_RCM       // reverse Cuthill-McKee
+};
+
+// Decomposition selects how each level of rsssp cuts the graph before recursing.
+enum Decomposition {
+    DECOMPOSE_BALLS,    // BCF23 ball carving around light vertices, one ball at a time
+    DECOMPOSE_SHIFTED   // exponential start-time shift clustering, one parallel pass
+};
+
 // SSSPConfig manages universal config to solve SSSP, such as RNG or time budget.
 struct SSSPConfig {
     OperationCapper *capper;
     mt19937_64 rng;
+    size_t num_threads = 1;
+    ValidationPolicy validation;
+    NonNegativeEngine engine = ENGINE_DIJKSTRA;
+    // materialize reduced weights once per potential change (Graph::cache_reduced_weights)
+    bool cache_reduced_weights = false;
+    VertexOrder vertex_order = ORDER_NONE;
+    Decomposition decomposition = DECOMPOSE_BALLS;
+    // solve sssp() on the vertices reachable from the source only. Negative cycles
+    // the source cannot reach are then not reported.
+    bool prune_unreachable = false;
+    // collapse parallel edges and self-loops before solving (see simplify.hpp).
+    bool simplify_multigraph = false;
+    // run each scaling round with int16_t / int32_t weights when they fit (see solve_rsssp_narrow).
+    bool narrow_weights = false;
+    // at the top level of rsssp, split a graph that is not strongly connected along its
+    // SCCs (cached per topology, see scc_topology) instead of carving it.
+    bool split_sccs_first = false;
 
     explicit SSSPConfig(OperationCapper *capper, mt19937_64 rng) : capper(capper), rng(rng) {}
 
@@ -0,0 +1,138 @@
+// Contraction of in-degree 1 / out-degree 1 chains.
+// A vertex v with a single in-edge (u -> v, w1) and a single out-edge (v -> x, w2 >= 0)
+// is replaced, together with its edges, by one edge u -> x of weight w1 + w2.
+// Since w2 >= 0 the new edge is never below -1 when the old ones were not, and it
+// carries at most as many negative edges, so restricted instances stay restricted.
+#pragma once
+#include "graph.hpp"
+#include "spresult.hpp"
+#include <vector>
+
+using namespace std;
+
+template <typename T, typename I = size_t>
+struct ChainContraction {
+    Graph<T, I> graph; // contracted graph
+    // original vertex index -> contracted vertex index, I(-1) for contracted vertices
+    vector<I> vertex_down_map;
+    // contracted vertex index -> original vertex index
+    vector<I> vertex_up_map;
+    // contracted edge index -> original edges of its path, in path order
+    vector<vector<I>> edge_up_map;
+
+    ChainContraction() : graph(0) {}
+
+    // lift translates an all-source witness on graph into one on the original graph g.
+    // Distances are taken w.r.t. the reduced weights of g, even if the solver changed
+    // the potential of graph. Along a path u -> v1 -> ... -> x, every inner vertex gets
+    //     d(v_k) = min(0, d(v_{k-1}) + w_k),
+    // as v_k is only reachable through v_{k-1}.
+    Witness<T, I> lift(Graph<T, I> &g, const Witness<T, I> &wit) const {
+        Witness<T, I> ret;
+        ret.state = wit.state;
+
+        for(auto edge_idx : wit.negative_cycle_witness) {
+            for(auto e : edge_up_map[edge_idx]) ret.negative_cycle_witness.emplace_back(e);
+        }
+        if(wit.state != SHORTEST_PATH_TREE_FOUND) return ret;
+
+        const auto &from = wit.shortest_path_tree_witness;
+        auto &to = ret.shortest_path_tree_witness;
+        to = ShortestPathTreeWitnessV2<T, I>(g.N());
+
+        const auto &phi = as_const(graph.phi), &phi_g = as_const(g.phi);
+        for(size_t v = 0, n = phi.size(); v < n; v++) {
+            size_t v_g = vertex_up_map[v];
+            to.dist[v_g] = from.dist[v] + g.potential_mult * (phi[v] - phi_g[v_g]);
+            I p = from.parent_edge_idx[v];
+            if(p != I(-1)) to.parent_edge_idx[v_g] = edge_up_map[p].back();
+        }
+
+        for(size_t c = 0, m = edge_up_map.size(); c < m; c++) {
+            const auto &path = edge_up_map[c];
+            // if the path is the tree edge of its end, all inner vertices are on the tree.
+            bool tree_path = from.parent_edge_idx[graph.edges[c].e] == I(c);
+
+            T d = to.dist[vertex_up_map[graph.edges[c].s]];
+            for(size_t k = 0; k + 1 < path.size(); k++) {
+                const auto &e = g.edges[path[k]];
+                d += g.get_weight(size_t(path[k]));
+                if(d < T(0) || tree_path) {
+                    to.parent_edge_idx[e.e] = path[k];
+                } else {
+                    d = T(0);
+                }
+                to.dist[e.e] = d;
+            }
+        }
+
+        return ret;
+    }
+};
+
+// contract_chains contracts every in-degree 1 / out-degree 1 vertex of g whose
+// out-edge has non-negative reduced weight. Deleted vertices and edges are not supported.
+template <typename T, typename I>
+ChainContraction<T, I> contract_chains(Graph<T, I> &g) {
+    size_t n = g.N();
+    ChainContraction<T, I> c;
+
+    vector<bool> removable(n, false);
+    for(size_t v = 0; v < n; v++) {
+        if(g.radj[v].size() != 1 || g.adj[v].size() != 1) continue;
+        const auto &in = g.edges[g.radj[v][0]];
+        removable[v] = in.s != v && g.get_weight(size_t(g.adj[v][0])) >= T(0);
+    }
+
+    // every removable vertex hangs on a chain out of a kept vertex, except on cycles
+    // made of removable vertices only. Keep one vertex of each such cycle.
+    vector<bool> covered(n, false);
+    auto cover_chains = [&](size_t v) {
+        for(auto edge_idx : g.adj[v]) {
+            size_t x = g.edges[edge_idx].e;
+            while(removable[x] && !covered[x]) {
+                covered[x] = true;
+                x = g.edges[g.adj[x][0]].e;
+            }
+        }
+    };
+    for(size_t v = 0; v < n; v++) {
+        if(!removable[v]) cover_chains(v);
+    }
+    for(size_t v = 0; v < n; v++) {
+        if(!removable[v] || covered[v]) continue;
+        removable[v] = false;
+        cover_chains(v);
+    }
+
+    c.vertex_down_map.assign(n, I(-1));
+    const auto &phi = as_const(g.phi);
+    c.graph.is_scc = g.is_scc;
+    c.graph.potential_mult = g.potential_mult;
+    c.graph.cache_reduced_weights = g.cache_reduced_weights;
+    for(size_t v = 0; v < n; v++) {
+        if(removable[v]) continue;
+        c.vertex_down_map[v] = c.vertex_up_map.size();
+        c.vertex_up_map.emplace_back(v);
+        c.graph.add_vertex(phi[v]);
+    }
+
+    for(size_t v = 0; v < n; v++) {
+        if(c.vertex_down_map[v] == I(-1)) continue;
+        for(auto edge_idx : g.adj[v]) {
+            vector<I> path({edge_idx});
+            T w = g.weight(edge_idx);
+            size_t x = g.edges[edge_idx].e;
+            while(c.vertex_down_map[x] == I(-1)) {
+                I next = g.adj[x][0];
+                path.emplace_back(next);
+                w += g.weight(next);
+                x = g.edges[next].e;
+            }
+            c.graph.add_edge({c.vertex_down_map[v], c.vertex_down_map[x], w});
+            c.edge_up_map.emplace_back(move(path));
+        }
+    }
+
+    return c;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "contract.hpp"
+#include "spalgo.hpp"
+#include "catch2/catch_all.hpp"
+
+using namespace std;
+
+// ring 0 -> 1 -> ... -> 9 -> 0 with a chord 0 -> 5.
+Graph<int> ring_with_chord(int closing_weight) {
+    Graph<int> g(10);
+    for(size_t i = 0; i < 9; i++) g.add_edge(Edge<int>({i, i + 1, 1}));
+    g.add_edge(Edge<int>({9, 0, closing_weight}));
+    g.add_edge(Edge<int>({0, 5, -1}));
+    return g;
+}
+
+TEST_CASE("contract chains and lift the tree", "[contract]") {
+    auto g = ring_with_chord(-1);
+    auto c = contract_chains(g);
+
+    // 0 and 5 have two in- or out-edges, and the out-edge of 9 is negative.
+    REQUIRE( c.vertex_up_map == vector<size_t>({0, 5, 9}) );
+    REQUIRE( c.graph.M() == 4 );
+    REQUIRE( c.edge_up_map[0] == vector<size_t>({0, 1, 2, 3, 4}) );
+
+    vector<size_t> all(c.graph.N());
+    iota(all.begin(), all.end(), 0);
+    auto wit = make_witness_for_sptree(bellman_ford::multi_source(c.graph, all));
+    auto lifted = c.lift(g, wit);
+
+    REQUIRE( lifted.state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( lifted.shortest_path_tree_witness.dist == bellman_ford::all_source(g).dist );
+    REQUIRE( validate_shortest_path_tree(g, lifted.shortest_path_tree_witness) );
+}
+
+TEST_CASE("contract chains and lift a cycle", "[contract]") {
+    auto g = ring_with_chord(-10);
+    auto c = contract_chains(g);
+
+    vector<size_t> all(c.graph.N());
+    iota(all.begin(), all.end(), 0);
+    auto wit = bellman_ford::spfa(c.graph, all);
+    REQUIRE( wit.state == NEGATIVE_CYCLE_FOUND );
+
+    auto lifted = c.lift(g, wit);
+
+    REQUIRE( lifted.state == NEGATIVE_CYCLE_FOUND );
+    REQUIRE( lifted.validate(g) );
+}
\ No newline at end of file
@@ -1,48 +1,156 @@
 #pragma once
 
+#include "kernels.hpp"
+#include <cassert>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include <queue>
 #include <unordered_set>
 using namespace std;
 
 // Directional Edge with weight.
-template <typename T>
+// I is the vertex / edge index type: size_t, or uint32_t for compact graphs
+// with less than 2^32 - 1 vertices and edges (I(-1) is reserved as "none").
+template <typename T, typename I = size_t>
 struct Edge {
-    size_t s, e; // s -> e
+    I s, e; // s -> e
     T w;
 
-    bool operator== (const Edge<T> &other) const {
+    bool operator== (const Edge<T, I> &other) const {
         return s == other.s && e == other.e && w == other.w;
     }
 };
 
-// Graph struct with edge weights and vertex potential.
+// Endpoints of an edge stored in a Graph. Its weight is only in Graph::soa.w;
+// Graph::edge(i) gives the whole Edge.
+template <typename I = size_t>
+struct EdgeEnds {
+    I s, e; // s -> e
+};
+
+// Structure-of-arrays edge store, for whole-edge sweeps (see kernels.hpp).
+// w is the only copy of the edge weights.
+template <typename T, typename I = size_t>
+struct EdgeArrays {
+    vector<I> src, dst;
+    vector<T> w;
+
+    void push_back(const Edge<T, I> &e) {
+        src.emplace_back(e.s);
+        dst.emplace_back(e.e);
+        w.emplace_back(e.w);
+    }
+};
+
+// vector of vertex potentials that counts its modifications, so caches derived
+// from it (Graph::reduced_weights) know when to refresh.
+// Every write counts as a modification; reads never do.
 template <typename T>
+struct PotentialVector {
+    vector<T> v;
+    size_t version = 0;
+
+    PotentialVector(size_t n = 0) : v(n) {}
+
+    PotentialVector &operator=(const vector<T> &other) {
+        v = other;
+        ++version;
+        return *this;
+    }
+
+    operator const vector<T> &() const { return v; }
+
+    bool operator==(const vector<T> &other) const { return v == other; }
+
+    size_t size() const { return v.size(); }
+
+    void emplace_back(T x) { ++version; v.emplace_back(x); }
+
+    // element access is read-only; writes go through the methods below.
+    const T &operator[](size_t i) const { return v[i]; }
+    const T *data() const { return v.data(); }
+    typename vector<T>::const_iterator begin() const { return v.begin(); }
+    typename vector<T>::const_iterator end() const { return v.end(); }
+
+    void set(size_t i, T x) { ++version; v[i] = x; }
+    void add(size_t i, T x) { ++version; v[i] += x; }
+    void fill(T x) { ++version; std::fill(v.begin(), v.end(), x); }
+
+    // for bulk writes through a pointer: call touch() once they are done.
+    T *mutable_data() { return v.data(); }
+    void touch() { ++version; }
+};
+
+// structures derived from the vertices and edges of a graph alone: weights, potential
+// and deletions do not change them. Filled once, on first use (see scc_topology).
+template <typename I = size_t>
+struct GraphTopology {
+    once_flag once;
+    atomic<bool> filled{false}; // set once the fields below are, inside once
+    size_t num_scc = 0;
+    vector<I> scc_order; // vertices grouped by SCC, SCCs in topological order
+    vector<I> scc_begin; // SCC c -> scc_order[scc_begin[c] .. scc_begin[c + 1])
+};
+
+// Graph struct with edge weights and vertex potential.
+// I: index type of vertices and edges, see Edge.
+template <typename T, typename I = size_t>
 struct Graph {
-    vector<T> phi; // vertex-wide potential
-    vector<Edge<T>> edges; // edges
-    vector<vector<size_t>> adj, radj; // adjacency list
+    using index_type = I;
+
+    PotentialVector<T> phi; // vertex-wide potential
+    vector<EdgeEnds<I>> edges; // edge endpoints, by edge index
+    // the same edges with their weights, structure of arrays. Weights change
+    // through set_weight() and the whole-array methods below only.
+    EdgeArrays<T, I> soa;
+    vector<vector<I>> adj, radj; // adjacency list
     bool is_scc; // original graph, or SCC?
 
-    unordered_set<size_t> delv, dele; // deleted vertices, edges;
+    unordered_set<I> delv, dele; // deleted vertices, edges;
     bool use_dels;
 
     T potential_mult = 1;
 
-    Graph(size_t n, bool is_scc = false) : phi(n), adj(n), radj(n), is_scc(is_scc), use_dels(false) {}
+    // if set, reduced_weights() materializes get_weight for all edges once per
+    // change of phi, potential_mult or edge weights, and hot loops read that array.
+    bool cache_reduced_weights = false;
+    size_t weights_version = 0; // bumped whenever an edge weight changes
+    vector<T> _reduced;
+    size_t _reduced_phi_version = size_t(-1), _reduced_weights_version = size_t(-1);
+    T _reduced_mult = 0;
+
+    // shared by copies, so the scaling rounds, which copy the graph and change weights
+    // only, compute it once. Structural edits detach it (see _topology_changed).
+    shared_ptr<GraphTopology<I>> topology;
+
+    Graph(size_t n, bool is_scc = false) : phi(n), adj(n), radj(n), is_scc(is_scc), use_dels(false),
+        topology(make_shared<GraphTopology<I>>()) {}
+
+    // drops the topology cache of this graph, unless it is still empty and not shared.
+    void _topology_changed() {
+        if(topology.use_count() > 1 || topology->filled.load()) topology = make_shared<GraphTopology<I>>();
+    }
 
     void add_vertex(T phi_value=0) {
+        _topology_changed();
         phi.emplace_back(phi_value);
         adj.emplace_back();
         radj.emplace_back();
     }
 
-    void add_edge(const Edge<T> e) {
+    void add_edge(const Edge<T, I> e) {
         assert(0 <= e.s && e.s < N()); // zero-based
         assert(0 <= e.e && e.e < N());
 
-        edges.push_back(e);
-        auto edge_idx =  M() -1;
+        _topology_changed();
+        edges.push_back({e.s, e.e});
+        soa.push_back(e);
+        ++weights_version;
+        I edge_idx = M() - 1;
 
         adj[e.s].push_back(edge_idx);
         radj[e.e].push_back(edge_idx);
@@ -64,29 +172,114 @@ struct Graph {
         return vector<T>(N(), numeric_limits<T>::max());
     }
 
-    T get_weight(const Edge<T> &e) {
-        return e.w + potential_mult * (phi[e.s] - phi[e.e]);
+    // the stored edge edge_idx, with its weight.
+    Edge<T, I> edge(size_t edge_idx) const {
+        return {edges[edge_idx].s, edges[edge_idx].e, soa.w[edge_idx]};
     }
 
-    T get_min_edge_weight() {
-        if(edges.empty()) return numeric_limits<T>::max();
-        auto it = min_element(edges.begin(), edges.end(), [&](const Edge<T> &e, const Edge<T> &f) {
-            return get_weight(e) < get_weight(f);
-        });
-        return get_weight(*it);
+    T weight(size_t edge_idx) const {
+        return soa.w[edge_idx];
     }
 
-    Graph<T> transpose() {
-        Graph<T> gt(*this);
+    // all edges with their weights, by edge index.
+    vector<Edge<T, I>> edge_list() const {
+        vector<Edge<T, I>> ret;
+        ret.reserve(edges.size());
+        for(size_t i = 0, m = edges.size(); i < m; i++) ret.emplace_back(edge(i));
+        return ret;
+    }
+
+    // reduced weight of e under the potential.
+    T get_weight(const Edge<T, I> &e) {
+        const auto &p = as_const(phi);
+        return e.w + potential_mult * (p[e.s] - p[e.e]);
+    }
+
+    // reduced weight of the stored edge edge_idx.
+    T get_weight(size_t edge_idx) {
+        const auto &p = as_const(phi);
+        const auto &e = edges[edge_idx];
+        return soa.w[edge_idx] + potential_mult * (p[e.s] - p[e.e]);
+    }
+
+    // get_weight of every edge, by edge index. Recomputed only when stale.
+    const vector<T> &reduced_weights(size_t num_threads = 1) {
+        if(
+            _reduced_phi_version != phi.version
+            || _reduced_weights_version != weights_version
+            || _reduced_mult != potential_mult
+        ) {
+            _reduced.resize(M());
+            kernels::reduced_weights(
+                soa.src.data(), soa.dst.data(), soa.w.data(), as_const(phi).data(),
+                potential_mult, _reduced.data(), M(), num_threads
+            );
+            _reduced_phi_version = phi.version;
+            _reduced_weights_version = weights_version;
+            _reduced_mult = potential_mult;
+        }
+        return _reduced;
+    }
+
+    T get_min_edge_weight(size_t num_threads = 1) {
+        return kernels::min_reduced_weight(
+            soa.src.data(), soa.dst.data(), soa.w.data(), as_const(phi).data(),
+            potential_mult, M(), num_threads
+        );
+    }
+
+    // changes the weight of one edge.
+    void set_weight(size_t edge_idx, T w) {
+        soa.w[edge_idx] = w;
+        ++weights_version;
+    }
+
+    // multiplies every edge weight by mult.
+    void scale_weights(T mult, size_t num_threads = 1) {
+        kernels::scale(soa.w.data(), mult, M(), num_threads);
+        ++weights_version;
+    }
+
+    // adds c to every edge weight.
+    void shift_weights(T c, size_t num_threads = 1) {
+        kernels::shift(soa.w.data(), c, M(), num_threads);
+        ++weights_version;
+    }
+
+    // replaces every edge weight w by ceil(w / d) + c, for d > 0.
+    void ceil_div_weights(T d, T c, size_t num_threads = 1) {
+        kernels::ceil_div_shift(soa.w.data(), d, c, M(), num_threads);
+        ++weights_version;
+    }
+
+    Graph<T, I> transpose() {
+        Graph<T, I> gt(*this);
         gt.adj.swap(gt.radj);
+        gt.topology = make_shared<GraphTopology<I>>(); // SCC order is reversed
 
         for(auto &e : gt.edges) {
             swap(e.s, e.e);
         }
+        gt.soa.src.swap(gt.soa.dst);
+        ++gt.weights_version; // reduced weights flip sign of the phi term
 
         return gt;
     }
 
+    // makes gt, the transpose() of a graph with this topology, the transpose of this
+    // graph again: weights, potential and deletions are copied, adjacency is kept.
+    void refresh_transpose(Graph<T, I> &gt) {
+        gt.phi = as_const(phi);
+        gt.soa.w = soa.w;
+        ++gt.weights_version;
+        gt.potential_mult = potential_mult;
+        gt.cache_reduced_weights = cache_reduced_weights;
+        gt.is_scc = is_scc;
+        gt.delv = delv;
+        gt.dele = dele;
+        gt.use_dels = use_dels;
+    }
+
     void enable_dels() {
         use_dels = true;
     }
@@ -128,11 +321,43 @@ struct Graph {
         potential_mult = T(1);
     }
 
-    void flush_potential() {
-        for(auto &e : edges) {
-            e.w = get_weight(e);
-        }
+    void flush_potential(size_t num_threads = 1) {
+        kernels::reduced_weights(
+            soa.src.data(), soa.dst.data(), soa.w.data(), as_const(phi).data(),
+            potential_mult, soa.w.data(), M(), num_threads
+        );
+        ++weights_version;
         
-        for(auto &ph : phi) ph = T(0);
+        phi.fill(T(0));
     }
-};
\ No newline at end of file
+};
+
+// ReducedWeightView reads get_weight by edge index: from g's cache when
+// g.cache_reduced_weights is set, computed on the fly otherwise.
+// It does not refresh itself, so take it after the caller's last change of phi.
+template <typename T, typename I = size_t>
+struct ReducedWeightView {
+    Graph<T, I> &g;
+    const T *cached;
+
+    ReducedWeightView(Graph<T, I> &g) : g(g), cached(g.cache_reduced_weights ? g.reduced_weights().data() : nullptr) {}
+
+    T operator()(size_t edge_idx) const {
+        return cached != nullptr ? cached[edge_idx] : g.get_weight(edge_idx);
+    }
+};
+
+// with_weight_type copies g with weights and potential stored as N, e.g. a narrower
+// integer type. Values must fit in N. Deletions are not copied; the topology is shared.
+template <typename N, typename T, typename I>
+Graph<N, I> with_weight_type(Graph<T, I> &g) {
+    Graph<N, I> h(0, g.is_scc);
+    const auto &phi = as_const(g.phi);
+    for(size_t v = 0, n = g.N(); v < n; v++) h.add_vertex(N(phi[v]));
+    h.edges.reserve(g.M());
+    for(size_t i = 0, m = g.M(); i < m; i++) h.add_edge({g.edges[i].s, g.edges[i].e, N(g.weight(i))});
+    h.potential_mult = N(g.potential_mult);
+    h.cache_reduced_weights = g.cache_reduced_weights;
+    h.topology = g.topology;
+    return h;
+}
\ No newline at end of file
@@ -31,7 +31,7 @@ TEST_CASE("graph_basic_tests", "[graph]") {
     }
 
     SECTION("manipulated potential") {
-        g.phi[0] = 1;
+        g.phi.set(0, 1);
         REQUIRE(g.get_weight(Edge<int>({0, 1, 2})) == 3);
     }
 
@@ -54,12 +54,117 @@ TEST_CASE("graph_basic_tests", "[graph]") {
 
         auto gt = g.transpose();
 
-        REQUIRE( original_edge == g.edges );
-        REQUIRE( expected_edge == gt.edges );
+        REQUIRE( original_edge == g.edge_list() );
+        REQUIRE( expected_edge == gt.edge_list() );
 
         REQUIRE( gt.deg(0) == 0 );
         REQUIRE( gt.deg(1) == 1 );
         REQUIRE( gt.deg(2) == 1 );
         REQUIRE( gt.deg(3) == 1 );
     }
+}
+
+TEST_CASE("edge arrays and weight kernels", "[graph]") {
+    Graph<int> g(3);
+
+    g.add_edge(Edge<int>({0, 1, 7}));
+    g.add_edge(Edge<int>({1, 2, -7}));
+    g.add_edge(Edge<int>({2, 0, 0}));
+
+    REQUIRE( g.soa.src == vector<size_t>({0, 1, 2}) );
+    REQUIRE( g.soa.dst == vector<size_t>({1, 2, 0}) );
+
+    SECTION("ceil division") {
+        g.ceil_div_weights(3, 1);
+        REQUIRE( g.soa.w == vector<int>({4, -1, 1}) );
+        REQUIRE( g.weight(1) == -1 );
+    }
+
+    SECTION("scale and shift") {
+        g.scale_weights(2);
+        g.shift_weights(-1);
+        REQUIRE( g.soa.w == vector<int>({13, -15, -1}) );
+        REQUIRE( g.weight(0) == 13 );
+    }
+
+    SECTION("flush potential") {
+        g.phi = vector<int>({1, 2, 3});
+        REQUIRE( g.get_min_edge_weight() == -8 );
+
+        g.flush_potential();
+        REQUIRE( g.soa.w == vector<int>({6, -8, 2}) );
+        REQUIRE( g.get_min_edge_weight() == -8 );
+        REQUIRE( g.phi == vector<int>({0, 0, 0}) );
+    }
+
+    SECTION("transpose swaps endpoints") {
+        auto gt = g.transpose();
+        REQUIRE( gt.soa.src == vector<size_t>({1, 2, 0}) );
+        REQUIRE( gt.soa.dst == vector<size_t>({0, 1, 2}) );
+    }
+}
+
+TEST_CASE("ceil division kernel", "[graph]") {
+    vector<int> w;
+    for(int x = -50; x <= 50; x++) w.emplace_back(x);
+    w.emplace_back(numeric_limits<int>::max() - 2);
+    w.emplace_back(numeric_limits<int>::min() + 2);
+
+    for(int d : {1, 3, 7, 1000}) {
+        auto v = w;
+        kernels::ceil_div_shift(v.data(), d, 0, v.size());
+        for(size_t i = 0; i < w.size(); i++) {
+            long long expected = (long long)ceil((long double)w[i] / d);
+            REQUIRE( v[i] == expected );
+        }
+    }
+}
+
+TEST_CASE("cached reduced weights follow phi", "[graph]") {
+    Graph<int> g(3);
+    g.cache_reduced_weights = true;
+
+    g.add_edge(Edge<int>({0, 1, 7}));
+    g.add_edge(Edge<int>({1, 2, -7}));
+
+    REQUIRE( g.reduced_weights() == vector<int>({7, -7}) );
+
+    g.phi.set(1, 2);
+    REQUIRE( g.reduced_weights() == vector<int>({5, -5}) );
+
+    g.ignore_potential();
+    REQUIRE( g.reduced_weights() == vector<int>({7, -7}) );
+    g.regard_potential();
+
+    g.shift_weights(1);
+    REQUIRE( g.reduced_weights() == vector<int>({6, -4}) );
+
+    auto gt = g.transpose();
+    REQUIRE( gt.reduced_weights() == vector<int>({10, -8}) );
+
+    ReducedWeightView<int> weight(g);
+    REQUIRE( weight(1) == -4 );
+}
+
+TEST_CASE("potential version counts writes only", "[graph]") {
+    Graph<int> g(3);
+    g.add_edge(Edge<int>({0, 1, 7}));
+
+    size_t version = g.phi.version;
+    int sum = g.phi[0] + g.phi[1];
+    for(auto &ph : g.phi) sum += ph;
+    REQUIRE( sum == 0 );
+    REQUIRE( g.phi.version == version );
+
+    g.phi.add(2, 3);
+    REQUIRE( g.phi.version == version + 1 );
+
+    int *p = g.phi.mutable_data();
+    p[0] = 4;
+    g.phi.touch();
+    REQUIRE( g.phi.version == version + 2 );
+    REQUIRE( g.phi == vector<int>({4, 0, 3}) );
+
+    g.cache_reduced_weights = true;
+    REQUIRE( g.reduced_weights() == vector<int>({11}) );
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+// Whole-edge sweeps over structure-of-arrays edge storage.
+// Loops are kept branch-free over __restrict pointers so that the compiler
+// auto-vectorizes them (build with -O3, and BCF23_NATIVE=ON for gathers on phi).
+#pragma once
+#include "parallel.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+namespace kernels {
+    // out[i] = w[i] + mult * (phi[s[i]] - phi[e[i]]). out may alias w.
+    template <typename T, typename I>
+    void reduced_weights(
+        const I *s,
+        const I *e,
+        const T *w,
+        const T *__restrict phi,
+        T mult,
+        T *out,
+        size_t m,
+        size_t num_threads = 1
+    ) {
+        parallel_for(0, m, num_threads, [&](size_t lo, size_t hi, size_t) {
+            for(size_t i = lo; i < hi; i++) {
+                out[i] = w[i] + mult * (phi[s[i]] - phi[e[i]]);
+            }
+        }, size_t(1) << 16);
+    }
+
+    // min over i of w[i] + mult * (phi[s[i]] - phi[e[i]]), numeric_limits<T>::max() if m == 0.
+    template <typename T, typename I>
+    T min_reduced_weight(
+        const I *__restrict s,
+        const I *__restrict e,
+        const T *__restrict w,
+        const T *__restrict phi,
+        T mult,
+        size_t m,
+        size_t num_threads = 1
+    ) {
+        vector<T> part(max<size_t>(1, num_threads), numeric_limits<T>::max());
+        parallel_for(0, m, num_threads, [&](size_t lo, size_t hi, size_t t) {
+            T best = numeric_limits<T>::max();
+            for(size_t i = lo; i < hi; i++) {
+                T x = w[i] + mult * (phi[s[i]] - phi[e[i]]);
+                best = x < best ? x : best;
+            }
+            part[t] = best;
+        }, size_t(1) << 16);
+
+        T best = numeric_limits<T>::max();
+        for(auto x : part) best = x < best ? x : best;
+        return best;
+    }
+
+    // w[i] *= mult.
+    template <typename T>
+    void scale(T *__restrict w, T mult, size_t m, size_t num_threads = 1) {
+        parallel_for(0, m, num_threads, [&](size_t lo, size_t hi, size_t) {
+            for(size_t i = lo; i < hi; i++) w[i] *= mult;
+        }, size_t(1) << 16);
+    }
+
+    // w[i] += c.
+    template <typename T>
+    void shift(T *__restrict w, T c, size_t m, size_t num_threads = 1) {
+        parallel_for(0, m, num_threads, [&](size_t lo, size_t hi, size_t) {
+            for(size_t i = lo; i < hi; i++) w[i] += c;
+        }, size_t(1) << 16);
+    }
+
+    // w[i] = ceil(w[i] / d) + c, for d > 0.
+    // Up to 32-bit weights the division goes through double, which is exact there
+    // and vectorizes; x86 has no SIMD integer division.
+    template <typename T>
+    void ceil_div_shift(T *__restrict w, T d, T c, size_t m, size_t num_threads = 1) {
+        parallel_for(0, m, num_threads, [&](size_t lo, size_t hi, size_t) {
+            if constexpr (is_integral_v<T> && sizeof(T) <= 4) {
+                const double inv = 1.0 / double(d);
+                const int64_t dd = d;
+                for(size_t i = lo; i < hi; i++) {
+                    // q is within one of the true quotient; fix it up without branches.
+                    int64_t x = w[i], q = int64_t(double(x) * inv);
+                    q += int64_t(q * dd < x) - int64_t((q - 1) * dd >= x);
+                    w[i] = T(q + c);
+                }
+            } else if constexpr (is_integral_v<T>) {
+                for(size_t i = lo; i < hi; i++) {
+                    w[i] = w[i] / d + T(w[i] % d > 0) + c;
+                }
+            } else {
+                for(size_t i = lo; i < hi; i++) {
+                    w[i] = ceil(w[i] / d) + c;
+                }
+            }
+        }, size_t(1) << 16);
+    }
+} // kernels
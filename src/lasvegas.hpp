@@ -0,0 +1,124 @@
+// Las Vegas driver: rerun a randomized solver with fresh RNG streams and
+// geometrically growing budgets until it returns a validated witness.
+// Optionally races several seeds in parallel per attempt.
+#pragma once
+
+#include "config.hpp"
+#include "sssp.hpp"
+#include "rsssp.hpp"
+#include "spresult.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+struct LasVegasOptions {
+    size_t initial_budget = 1 << 16;
+    long double budget_growth = 2; // budget multiplier between rounds
+    size_t max_rounds = 16;
+    size_t racers = 1;             // seeds raced in parallel within one round
+    size_t seed = 0x5174;
+    size_t num_threads = 1;        // forwarded to SSSPConfig of every racer
+};
+
+template <typename T, typename I = size_t>
+struct LasVegasResult {
+    Witness<T, I> witness;
+    size_t attempts = 0;    // solver runs started, over all rounds and racers
+    size_t rounds = 0;
+    size_t spent_work = 0;  // capper operations spent over all attempts
+};
+
+// las_vegas runs solve(cfg) until it returns a witness accepted by validate(wit).
+// Each attempt gets its own capper and an RNG seeded from (seed, round, racer).
+// Racers of a round stop as soon as one of them has a validated witness.
+template <typename T, typename I = size_t, typename Solver, typename Validator>
+LasVegasResult<T, I> las_vegas(
+    Solver solve,
+    Validator validate,
+    const LasVegasOptions &opt
+) {
+    LasVegasResult<T, I> res;
+    long double budget = opt.initial_budget;
+    size_t racers = max<size_t>(1, opt.racers);
+
+    for(size_t round = 0; round < opt.max_rounds; round++, budget *= opt.budget_growth) {
+        atomic<bool> done(false);
+        mutex result_lock;
+        vector<size_t> spent(racers, 0);
+
+        auto attempt = [&](size_t racer) {
+            CancellableOperationCapper capper(size_t(budget), &done);
+            seed_seq seq({opt.seed, size_t(round), racer});
+            mt19937_64 rng(seq);
+
+            SSSPConfig cfg(&capper, rng);
+            cfg.num_threads = opt.num_threads;
+
+            Witness<T, I> wit = solve(cfg);
+            spent[racer] = capper.counter;
+
+            if(capper.fail() || !validate(wit)) return;
+
+            // first validated witness wins.
+            lock_guard<mutex> lock(result_lock);
+            if(!done.exchange(true)) res.witness = move(wit);
+        };
+
+        vector<thread> workers;
+        for(size_t r = 1; r < racers; r++) workers.emplace_back(attempt, r);
+        attempt(0);
+        for(auto &w : workers) w.join();
+
+        res.attempts += racers;
+        res.rounds = round + 1;
+        for(auto s : spent) res.spent_work += s;
+
+        if(done) return res;
+        cerr << "las vegas round " << round << " failed with budget " << size_t(budget) << '\n';
+    }
+
+    res.witness = Witness<T, I>();
+    return res;
+}
+
+// sssp with retries. See las_vegas.
+template <typename T, typename I>
+LasVegasResult<T, I> las_vegas_sssp(
+    Graph<T, I> &g,
+    size_t src,
+    const LasVegasOptions &opt = LasVegasOptions()
+) {
+    return las_vegas<T, I>(
+        [&](SSSPConfig &cfg) { return sssp(g, src, cfg); },
+        [&](Witness<T, I> &wit) { return wit.validate(g, opt.num_threads); },
+        opt
+    );
+}
+
+// solve_rsssp with retries. See las_vegas.
+// g itself is left untouched; every attempt solves its own copy, and its distances
+// are translated to the potential of g.
+template <typename T, typename I>
+LasVegasResult<T, I> las_vegas_rsssp(
+    Graph<T, I> &g,
+    const LasVegasOptions &opt = LasVegasOptions()
+) {
+    return las_vegas<T, I>(
+        [&](SSSPConfig &cfg) {
+            Graph<T, I> h = g;
+            auto wit = solve_rsssp(h, cfg);
+            if(wit.state == SHORTEST_PATH_TREE_FOUND) {
+                auto &dist = wit.shortest_path_tree_witness.dist;
+                const auto &phi_h = as_const(h.phi), &phi_g = as_const(g.phi);
+                for(size_t v = 0; v < dist.size(); v++) {
+                    if(dist[v] != numeric_limits<T>::max()) dist[v] += g.potential_mult * (phi_h[v] - phi_g[v]);
+                }
+            }
+            return wit;
+        },
+        [&](Witness<T, I> &wit) { return wit.validate(g, opt.num_threads); },
+        opt
+    );
+}
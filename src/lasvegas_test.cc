@@ -0,0 +1,71 @@
+#include "lasvegas.hpp"
+#include "catch2/catch_all.hpp"
+
+// gen_dag makes a random DAG with negative weights, so it has no negative cycle.
+Graph<int> gen_dag(size_t n, size_t m, int min_weight, size_t seed) {
+    Graph<int> g(n);
+    mt19937 rng(seed);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(min_weight, 20);
+
+    for(size_t i = 0; i < m; i++) {
+        size_t a = v(rng), b = v(rng);
+        while(a == b) b = v(rng);
+        if(a > b) swap(a, b);
+        g.add_edge(Edge<int>({a, b, wt(rng)}));
+    }
+
+    return g;
+}
+
+TEST_CASE("retries with growing budget", "[lasvegas]") {
+    for(auto [n, seed] : vector<pair<size_t, size_t>>({{20, 0x4834}, {45, 0x51}, {120, 0x7e57}})) {
+        Graph<int> g = gen_dag(n, 3 * n / 2, -300, seed);
+
+        LasVegasOptions opt;
+        opt.initial_budget = 100;
+        opt.budget_growth = 4;
+
+        auto res = las_vegas_sssp(g, 0, opt);
+
+        REQUIRE( res.witness.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( res.witness.validate(g) );
+        REQUIRE( res.rounds > 1 );
+        REQUIRE( res.attempts == res.rounds );
+        REQUIRE( res.spent_work > 100 );
+
+        auto bf = bellman_ford::single_source(g, 0);
+        REQUIRE( validate_shortest_path_tree(g, bf) );
+        REQUIRE( res.witness.shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+}
+
+TEST_CASE("racing seeds", "[lasvegas]") {
+    Graph<int> g = gen_dag(15, 40, -1, 0x1357);
+
+    LasVegasOptions opt;
+    opt.initial_budget = 1000;
+    opt.racers = 3;
+
+    auto res = las_vegas_rsssp(g, opt);
+
+    REQUIRE( res.witness.state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( res.witness.validate(g) );
+    REQUIRE( res.attempts == 3 * res.rounds );
+    // input graph is untouched
+    REQUIRE( g.phi == vector<int>(15, 0) );
+}
+
+TEST_CASE("gives up after max_rounds", "[lasvegas]") {
+    Graph<int> g = gen_dag(20, 30, -300, 0x4834);
+
+    LasVegasOptions opt;
+    opt.initial_budget = 1;
+    opt.budget_growth = 1;
+    opt.max_rounds = 3;
+
+    auto res = las_vegas_sssp(g, 0, opt);
+
+    REQUIRE( res.witness.state == UNKNOWN );
+    REQUIRE( res.rounds == 3 );
+}
\ No newline at end of file
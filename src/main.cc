@@ -1,8 +1,300 @@
-#include <vector>
+// bcf23 query server.
+// Loads a graph once, then answers sssp queries line by line from stdin,
+// or from every client of a Unix domain socket. See README.md for the protocol.
+#include "batch.hpp"
+#include "graph.hpp"
+#include "sptree.hpp"
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 using namespace std;
+using Weight = long long;
+
+struct ServerOptions {
+    string graph_path;      // read the graph from stdin if empty
+    string socket_path;     // serve stdin / stdout if empty
+    size_t max_batch = 256; // queries solved together at most
+    BatchOptions batch;
+};
+
+// LineReader reads lines from a file descriptor. ready() tells whether a whole
+// line is already buffered, so queries sent together can be solved together
+// without waiting for input that may never come.
+struct LineReader {
+    int fd;
+    string buf;
+    size_t pos = 0;
+    bool eof = false;
+
+    LineReader(int fd) : fd(fd) {}
+
+    bool ready() const {
+        return buf.find('\n', pos) != string::npos;
+    }
+
+    bool next(string &line) {
+        while(!ready() && !eof) {
+            char tmp[1 << 16];
+            ssize_t k = read(fd, tmp, sizeof(tmp));
+            if(k <= 0) {
+                eof = true;
+                break;
+            }
+            buf.erase(0, pos);
+            pos = 0;
+            buf.append(tmp, k);
+        }
+
+        if(pos >= buf.size()) return false;
+
+        size_t nl = buf.find('\n', pos);
+        if(nl == string::npos) nl = buf.size();
+        line = buf.substr(pos, nl - pos);
+        pos = min(buf.size(), nl + 1);
+        return true;
+    }
+};
+
+bool write_all(int fd, const string &s) {
+    for(size_t off = 0; off < s.size(); ) {
+        ssize_t k = write(fd, s.data() + off, s.size() - off);
+        if(k <= 0) return false;
+        off += k;
+    }
+    return true;
+}
+
+// load_graph reads "n m" and then m lines "s e w", vertices zero-based.
+bool load_graph(LineReader &in, Graph<Weight> &g) {
+    string line;
+    size_t n = 0, m = 0;
+    while(in.next(line)) {
+        if(istringstream(line) >> n >> m) break;
+    }
+
+    g = Graph<Weight>(n);
+    for(size_t i = 0; i < m; i++) {
+        size_t s, e;
+        Weight w;
+        if(!in.next(line) || !(istringstream(line) >> s >> e >> w) || s >= n || e >= n) {
+            cerr << "bad edge line " << i << ": " << line << '\n';
+            return false;
+        }
+        g.add_edge({s, e, w});
+    }
+    return true;
+}
+
+struct Server {
+    Graph<Weight> g{0};
+    shared_mutex graph_lock; // queries share it, weight updates take it exclusively
+    ServerOptions opt;
+
+    // pending query: distances from src (Q), the path from src to dst (P),
+    // or the vertex k edges above dst on the tree of src (A).
+    struct Query {
+        char kind;
+        size_t src, dst, k;
+    };
+
+    // answer solves a batch of queries, one sssp per distinct source.
+    string answer(const vector<Query> &queries) {
+        shared_lock<shared_mutex> lock(graph_lock);
+
+        vector<size_t> sources;
+        vector<size_t> slot(queries.size());
+        for(size_t i = 0; i < queries.size(); i++) {
+            auto it = find(sources.begin(), sources.end(), queries[i].src);
+            slot[i] = it - sources.begin();
+            if(it == sources.end()) sources.emplace_back(queries[i].src);
+        }
+
+        auto results = sssp_batch(g, sources, opt.batch);
+        vector<CompactTree<Weight>> trees(sources.size());
+
+        ostringstream out;
+        for(size_t i = 0; i < queries.size(); i++) {
+            const auto &q = queries[i];
+            const auto &wit = results[slot[i]];
+
+            if(wit.state == NEGATIVE_CYCLE_FOUND) {
+                out << "cycle";
+                for(auto edge_idx : wit.negative_cycle_witness) out << ' ' << edge_idx;
+                out << '\n';
+                continue;
+            }
+            if(wit.state != SHORTEST_PATH_TREE_FOUND) {
+                out << "unknown " << q.src << '\n';
+                continue;
+            }
+
+            const auto &tree = wit.shortest_path_tree_witness;
+            auto print_dist = [&](Weight d) {
+                if(d == numeric_limits<Weight>::max()) out << "inf";
+                else out << d;
+            };
+
+            if(q.kind == 'Q') {
+                out << "dist " << q.src;
+                for(auto d : tree.pure_dist) out << ' ', print_dist(d);
+                out << '\n';
+                continue;
+            }
+
+            // one compact tree per source, shared by the tree queries of the batch.
+            if(trees[slot[i]].n == 0) trees[slot[i]] = compact_tree(g, tree);
+            auto view = trees[slot[i]].view();
+
+            if(q.kind == 'A') {
+                size_t a = view.kth_ancestor(q.dst, q.k);
+                out << "ancestor " << q.src << ' ' << q.dst << ' ' << q.k << ' ';
+                if(a == size_t(-1)) out << "none";
+                else out << a;
+                out << '\n';
+                continue;
+            }
+
+            out << "path " << q.src << ' ' << q.dst << ' ';
+            print_dist(view.distance(q.dst));
+            for(auto edge_idx : view.path_edges(q.dst)) out << ' ' << edge_idx;
+            out << '\n';
+        }
+        return out.str();
+    }
+
+    // serve answers the commands read from in on out_fd until end of input.
+    void serve(LineReader &in, int out_fd) {
+        vector<Query> pending;
+        string line;
+        bool alive = true;
+
+        auto flush = [&]() {
+            if(pending.empty()) return;
+            alive = write_all(out_fd, answer(pending)) && alive;
+            pending.clear();
+        };
+
+        while(alive && in.next(line)) {
+            istringstream ss(line);
+            string cmd;
+            if(!(ss >> cmd)) continue;
+
+            Query q{cmd.size() == 1 ? cmd[0] : ' ', 0, 0, 0};
+            if(
+                (q.kind == 'Q' && ss >> q.src)
+                || (q.kind == 'P' && ss >> q.src >> q.dst)
+                || (q.kind == 'A' && ss >> q.src >> q.dst >> q.k)
+            ) {
+                if(q.src >= g.N() || q.dst >= g.N()) {
+                    flush();
+                    alive = write_all(out_fd, "error vertex out of range\n");
+                    continue;
+                }
+                pending.emplace_back(q);
+                // solve now unless more queries are already waiting.
+                if(!in.ready() || pending.size() >= opt.max_batch) flush();
+                continue;
+            }
+
+            // everything else is answered in order with the queries before it.
+            flush();
+
+            size_t edge_idx;
+            Weight w;
+            if(cmd == "U" && ss >> edge_idx >> w) {
+                unique_lock<shared_mutex> lock(graph_lock);
+                if(edge_idx >= g.M()) {
+                    alive = write_all(out_fd, "error edge out of range\n");
+                    continue;
+                }
+                g.set_weight(edge_idx, w);
+                alive = write_all(out_fd, "updated " + to_string(edge_idx) + "\n");
+            } else {
+                alive = write_all(out_fd, "error unknown command: " + line + "\n");
+            }
+        }
+        flush();
+    }
+
+    // serve_socket accepts clients on a Unix domain socket, one thread each.
+    int serve_socket() {
+        int srv = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, opt.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(opt.socket_path.c_str());
+
+        if(srv < 0 || ::bind(srv, (sockaddr *) &addr, sizeof(addr)) < 0 || listen(srv, 64) < 0) {
+            cerr << "cannot listen on " << opt.socket_path << ": " << strerror(errno) << '\n';
+            return 1;
+        }
+
+        while(true) {
+            int client = accept(srv, nullptr, nullptr);
+            if(client < 0) continue;
+            thread([this, client]() {
+                LineReader in(client);
+                serve(in, client);
+                close(client);
+            }).detach();
+        }
+    }
+};
+
+void usage() {
+    cerr << "usage: bcf23 [--graph FILE] [--socket PATH] [--threads N] [--budget B] [--max-batch K]\n";
+}
+
+int main(int argc, char **argv) {
+    Server server;
+    auto &opt = server.opt;
+
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        string val = argv[++i];
+        if(arg == "--graph") opt.graph_path = val;
+        else if(arg == "--socket") opt.socket_path = val;
+        else if(arg == "--threads") opt.batch.num_threads = stoul(val);
+        else if(arg == "--budget") opt.batch.budget = stoul(val);
+        else if(arg == "--max-batch") opt.max_batch = max<size_t>(1, stoul(val));
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    int graph_fd = opt.graph_path.empty() ? STDIN_FILENO : open(opt.graph_path.c_str(), O_RDONLY);
+    if(graph_fd < 0) {
+        cerr << "cannot open " << opt.graph_path << '\n';
+        return 1;
+    }
+
+    // without --graph, the graph and the queries share stdin and its reader.
+    LineReader graph_in(graph_fd);
+    if(!load_graph(graph_in, server.g)) return 1;
+
+    if(!opt.socket_path.empty()) return server.serve_socket();
 
-int main() {
-    cout << "Hello world!\n";
+    if(graph_fd == STDIN_FILENO) {
+        server.serve(graph_in, STDOUT_FILENO);
+    } else {
+        close(graph_fd);
+        LineReader in(STDIN_FILENO);
+        server.serve(in, STDOUT_FILENO);
+    }
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Minimal fork-join helpers on std::thread.
+// Every parallel kernel in this repo goes through parallel_for,
+// so the thread count is controlled from a single place (SSSPConfig::num_threads).
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// number of threads to use when the caller does not care.
+inline size_t hardware_threads() {
+    size_t t = thread::hardware_concurrency();
+    return t == 0 ? 1 : t;
+}
+
+// parallel_for splits [begin, end) into num_threads contiguous chunks
+// and calls f(chunk_begin, chunk_end, thread_idx) for each of them.
+// Runs inline when num_threads <= 1 or the range is smaller than min_chunk.
+template <typename F>
+void parallel_for(
+    size_t begin,
+    size_t end,
+    size_t num_threads,
+    F &&f,
+    size_t min_chunk = 1024
+) {
+    if(end <= begin) return;
+
+    size_t len = end - begin;
+    num_threads = max<size_t>(1, min(num_threads, (len + min_chunk - 1) / min_chunk));
+
+    if(num_threads == 1) {
+        f(begin, end, size_t(0));
+        return;
+    }
+
+    size_t chunk = (len + num_threads - 1) / num_threads;
+    vector<thread> workers;
+    workers.reserve(num_threads - 1);
+
+    for(size_t t = 1; t < num_threads; t++) {
+        size_t lo = begin + t * chunk, hi = min(end, lo + chunk);
+        if(lo >= hi) break;
+        workers.emplace_back([&f, lo, hi, t]() { f(lo, hi, t); });
+    }
+
+    // the calling thread takes the first chunk.
+    f(begin, min(end, begin + chunk), size_t(0));
+
+    for(auto &w : workers) w.join();
+}
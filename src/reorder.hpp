@@ -0,0 +1,209 @@
+// Vertex relabeling for locality.
+// Traversals touch the neighbours of a vertex right after the vertex itself, so
+// numbering vertices in BFS / reverse Cuthill-McKee order keeps dist, phi and
+// adjacency accesses close together. Edges are renumbered by new source as well.
+// A relabeling may also keep only some of the vertices (see reachable_subgraph).
+#pragma once
+#include "config.hpp"
+#include "graph.hpp"
+#include "spresult.hpp"
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+namespace internal {
+    // undirected neighbours of v (out- and in-edges), ignoring direction.
+    template <typename T, typename I, typename F>
+    void for_each_undirected_neighbour(Graph<T, I> &g, size_t v, F &&f) {
+        for(auto edge_idx : g.adj[v]) f(size_t(g.edges[edge_idx].e));
+        for(auto edge_idx : g.radj[v]) f(size_t(g.edges[edge_idx].s));
+    }
+
+    // breadth-first order over the undirected graph from the given roots.
+    // Neighbours are visited in ascending degree if by_degree is set (Cuthill-McKee).
+    template <typename T, typename I>
+    vector<size_t> breadth_first_order(
+        Graph<T, I> &g,
+        const vector<size_t> &roots,
+        bool by_degree
+    ) {
+        size_t n = g.N();
+        vector<size_t> order;
+        order.reserve(n);
+        vector<bool> visited(n, false);
+        vector<size_t> next;
+
+        auto degree = [&](size_t v) { return g.adj[v].size() + g.radj[v].size(); };
+
+        for(auto root : roots) {
+            if(visited[root]) continue;
+            visited[root] = true;
+            order.emplace_back(root);
+
+            // order doubles as the queue.
+            for(size_t head = order.size() - 1; head < order.size(); head++) {
+                next.clear();
+                for_each_undirected_neighbour(g, order[head], [&](size_t u) {
+                    if(visited[u]) return;
+                    visited[u] = true;
+                    next.emplace_back(u);
+                });
+                if(by_degree) {
+                    stable_sort(next.begin(), next.end(), [&](size_t a, size_t b) { return degree(a) < degree(b); });
+                }
+                for(auto u : next) order.emplace_back(u);
+            }
+        }
+
+        return order;
+    }
+}
+
+// bfs_order lists the vertices of g in breadth-first order, one component
+// after another, starting each from its smallest vertex index.
+template <typename T, typename I>
+vector<size_t> bfs_order(Graph<T, I> &g) {
+    vector<size_t> roots(g.N());
+    iota(roots.begin(), roots.end(), 0);
+    return internal::breadth_first_order(g, roots, false);
+}
+
+// rcm_order lists the vertices of g in reverse Cuthill-McKee order:
+// BFS from a minimum degree vertex, neighbours by ascending degree, reversed.
+template <typename T, typename I>
+vector<size_t> rcm_order(Graph<T, I> &g) {
+    vector<size_t> roots(g.N());
+    iota(roots.begin(), roots.end(), 0);
+    stable_sort(roots.begin(), roots.end(), [&](size_t a, size_t b) {
+        return g.adj[a].size() + g.radj[a].size() < g.adj[b].size() + g.radj[b].size();
+    });
+
+    auto order = internal::breadth_first_order(g, roots, true);
+    reverse(order.begin(), order.end());
+    return order;
+}
+
+// reachable_order lists the vertices reachable from src along out-edges, in BFS order.
+template <typename T, typename I>
+vector<size_t> reachable_order(Graph<T, I> &g, size_t src) {
+    vector<bool> visited(g.N(), false);
+    vector<size_t> order({src});
+    visited[src] = true;
+
+    // order doubles as the queue.
+    for(size_t head = 0; head < order.size(); head++) {
+        for(auto edge_idx : g.adj[order[head]]) {
+            size_t u = g.edges[edge_idx].e;
+            if(visited[u]) continue;
+            visited[u] = true;
+            order.emplace_back(u);
+        }
+    }
+
+    return order;
+}
+
+// ReorderedGraph is a relabeled copy of a graph, with the maps to translate back.
+template <typename T, typename I = size_t>
+struct ReorderedGraph {
+    Graph<T, I> graph;
+    vector<I> vertex_down_map; // original vertex index -> new vertex index, I(-1) if dropped
+    vector<I> vertex_up_map;   // new vertex index -> original vertex index
+    vector<I> edge_up_map;     // new edge index -> original edge index
+
+    ReorderedGraph() : graph(0) {}
+
+    // lift translates a witness on graph into one on the original graph.
+    // Dropped vertices get infinite distances and no parent edge.
+    Witness<T, I> lift(const Witness<T, I> &wit) const {
+        Witness<T, I> ret;
+        ret.state = wit.state;
+
+        for(auto edge_idx : wit.negative_cycle_witness) {
+            ret.negative_cycle_witness.emplace_back(edge_up_map[edge_idx]);
+        }
+        if(wit.state != SHORTEST_PATH_TREE_FOUND) return ret;
+
+        const auto &from = wit.shortest_path_tree_witness;
+        auto &to = ret.shortest_path_tree_witness;
+        size_t n = from.dist.size(), n_g = vertex_down_map.size();
+        to = ShortestPathTreeWitnessV2<T, I>(n_g);
+        to.dist.assign(n_g, numeric_limits<T>::max());
+        if(!from.pure_dist.empty()) to.pure_dist.assign(n_g, numeric_limits<T>::max());
+
+        for(size_t v = 0; v < n; v++) {
+            size_t v_g = vertex_up_map[v];
+            to.dist[v_g] = from.dist[v];
+            if(!from.pure_dist.empty()) to.pure_dist[v_g] = from.pure_dist[v];
+            if(from.parent_edge_idx[v] != I(-1)) to.parent_edge_idx[v_g] = edge_up_map[from.parent_edge_idx[v]];
+        }
+
+        return ret;
+    }
+};
+
+// reorder relabels the vertices of g as listed in order (order[new] = old),
+// and sorts the edges by (new source, new target). Vertices missing from order
+// are dropped, with every edge touching them.
+// phi, potential_mult and cache_reduced_weights carry over; deletions do not.
+template <typename T, typename I>
+ReorderedGraph<T, I> reorder(Graph<T, I> &g, const vector<size_t> &order) {
+    size_t n = g.N(), m = g.M();
+    assert(order.size() <= n);
+
+    ReorderedGraph<T, I> r;
+    r.vertex_up_map.assign(order.begin(), order.end());
+    r.vertex_down_map.assign(n, I(-1));
+    for(size_t v = 0; v < order.size(); v++) r.vertex_down_map[order[v]] = v;
+
+    for(size_t edge_idx = 0; edge_idx < m; edge_idx++) {
+        const auto &e = g.edges[edge_idx];
+        if(r.vertex_down_map[e.s] != I(-1) && r.vertex_down_map[e.e] != I(-1)) r.edge_up_map.emplace_back(edge_idx);
+    }
+    sort(r.edge_up_map.begin(), r.edge_up_map.end(), [&](I a, I b) {
+        const auto &ea = g.edges[a], &eb = g.edges[b];
+        return pair(r.vertex_down_map[ea.s], r.vertex_down_map[ea.e])
+            < pair(r.vertex_down_map[eb.s], r.vertex_down_map[eb.e]);
+    });
+
+    Graph<T, I> &h = r.graph;
+    h.is_scc = g.is_scc;
+    h.potential_mult = g.potential_mult;
+    h.cache_reduced_weights = g.cache_reduced_weights;
+
+    const auto &phi = as_const(g.phi);
+    for(auto v : order) h.add_vertex(phi[v]);
+    for(auto edge_idx : r.edge_up_map) {
+        const auto &e = g.edges[edge_idx];
+        h.add_edge({r.vertex_down_map[e.s], r.vertex_down_map[e.e], g.weight(edge_idx)});
+    }
+
+    return r;
+}
+
+// reorder g by the given VertexOrder. ORDER_NONE keeps the labels (and still copies g).
+template <typename T, typename I>
+ReorderedGraph<T, I> reorder(Graph<T, I> &g, VertexOrder order) {
+    vector<size_t> perm;
+    switch(order) {
+        case ORDER_BFS:
+        perm = bfs_order(g);
+        break;
+        case ORDER_RCM:
+        perm = rcm_order(g);
+        break;
+        case ORDER_NONE:
+        perm.resize(g.N());
+        iota(perm.begin(), perm.end(), 0);
+        break;
+    }
+    return reorder(g, perm);
+}
+
+// reachable_subgraph keeps the vertices reachable from src, in BFS order (src becomes 0).
+// Nothing outside it can change a distance from src, nor lie on a cycle src reaches.
+template <typename T, typename I>
+ReorderedGraph<T, I> reachable_subgraph(Graph<T, I> &g, size_t src) {
+    return reorder(g, reachable_order(g, src));
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "reorder.hpp"
+#include "sssp.hpp"
+#include "catch2/catch_all.hpp"
+
+using namespace std;
+
+TEST_CASE("reordering a shuffled path", "[reorder]") {
+    size_t n = 50;
+    vector<size_t> label(n);
+    iota(label.begin(), label.end(), 0);
+    mt19937 rng(0x3c1);
+    shuffle(label.begin(), label.end(), rng);
+
+    Graph<int> g(n);
+    for(size_t i = 0; i + 1 < n; i++) {
+        g.add_edge(Edge<int>({label[i], label[i + 1], int(i)}));
+    }
+
+    auto order = GENERATE(ORDER_BFS, ORDER_RCM);
+    auto r = reorder(g, order);
+
+    REQUIRE( r.graph.N() == n );
+    REQUIRE( r.graph.M() == n - 1 );
+
+    // rcm walks the path from one end. bfs starts at vertex 0, which may be in the
+    // middle, and alternates between the two halves. Edges are sorted by source.
+    size_t bandwidth = order == ORDER_RCM ? 1 : 2;
+    for(size_t i = 0; i < r.graph.M(); i++) {
+        const auto &e = r.graph.edges[i];
+        REQUIRE( max(e.s, e.e) - min(e.s, e.e) <= bandwidth );
+        if(i > 0) REQUIRE( r.graph.edges[i - 1].s <= e.s );
+
+        const auto &orig = g.edges[r.edge_up_map[i]];
+        REQUIRE( r.vertex_up_map[e.s] == orig.s );
+        REQUIRE( r.vertex_up_map[e.e] == orig.e );
+        REQUIRE( r.graph.weight(i) == g.weight(r.edge_up_map[i]) );
+    }
+}
+
+TEST_CASE("sssp with reordered vertices", "[reorder]") {
+    Graph<int> g(20);
+
+    mt19937 rng(0x4834);
+    uniform_int_distribution<int> v(0, 19), wt(-300, 20);
+
+    for(int i = 0; i < 30; i++) {
+        size_t a = v(rng), b = v(rng);
+        while(a == b) b = v(rng);
+        if(a > b) swap(a, b);
+
+        g.add_edge(Edge<int>({a, b, wt(rng)}));
+    }
+
+    SSSPConfig cfg(60000);
+    cfg.vertex_order = GENERATE(ORDER_BFS, ORDER_RCM);
+
+    auto wit = sssp(g, 3, cfg);
+    auto bf = bellman_ford::single_source(g, 3);
+
+    REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( wit.validate(g) );
+    REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+
+    // cycles come back as edge indices of g.
+    g.add_edge(Edge<int>({19, 0, -100000}));
+    auto cyc = sssp(g, 3, cfg);
+
+    REQUIRE( cyc.state == NEGATIVE_CYCLE_FOUND );
+    REQUIRE( cyc.validate(g) );
+}
\ No newline at end of file
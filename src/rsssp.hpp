@@ -7,6 +7,8 @@
 #include "spalgo.hpp"
 #include "spresult.hpp"
 #include "scc.hpp"
+#include "contract.hpp"
+#include <bitset>
 
 constexpr size_t LOW_KAPPA_LIMIT = 2;
 constexpr long double BALL_ESTIMATION_ADDITIVE_ERROR = 0.125; // eps such that additive error <= eps * n
@@ -16,9 +18,11 @@ constexpr long double RADIUS_TEMPERATURE = 20;
 
 // List up in light vertices (in ball size <= 3n/4, estimated)
 // N >= 2 is assumed.
-template <typename T>
+// The sampled balls are grown 64 at a time (bit_parallel::ball_masks), and each
+// vertex counts the samples reaching it with a popcount of its mask.
+template <typename T, typename I>
 vector<size_t> get_in_light_vertices(
-    Graph<T> &g,
+    Graph<T, I> &g,
     size_t kappa,
     SSSPConfig &cfg
 ) {
@@ -26,15 +30,23 @@ vector<size_t> get_in_light_vertices(
     uniform_int_distribution<size_t> vertex_sampler(0, n - 1);
     size_t k = ceil(BALL_ESTIMATOR_SAMPLE_COEFF * log(n));
 
+    vector<size_t> samples(k);
+    for(auto &v : samples) v = vertex_sampler(cfg.rng);
+
     vector<size_t> ball_counter(n);
-    
-    for(size_t i = 0; i < k; i++) {
-        auto v = vertex_sampler(cfg.rng);
+    vector<uint64_t> mask(n, 0);
+    vector<size_t> touched;
 
+    for(size_t i = 0; i < k; i += 64) {
         if(!cfg.capper -> incr()) return vector<size_t>();
-        auto wit = naive_dijkstra::single_source(g, v, true);
 
-        for(size_t j = 0; j < n; j++) ball_counter[j] += (wit.dist[j] <= kappa / 4);
+        vector<size_t> batch(samples.begin() + i, samples.begin() + min(k, i + 64));
+        bit_parallel::ball_masks(g, batch, T(kappa / 4), mask, touched);
+
+        for(auto j : touched) {
+            ball_counter[j] += bitset<64>(mask[j]).count();
+            mask[j] = 0;
+        }
     }
 
     vector<size_t> ret;
@@ -47,53 +59,108 @@ vector<size_t> get_in_light_vertices(
     return ret;
 }
 
-// internal function to solve rsssp.
-template <typename T>
-Witness<T> _solve_rsssp(
-    Graph<T> &g,
-    size_t kappa,
-    SSSPConfig &cfg
+// validate_witness checks a witness found at the given recursion depth,
+// as thoroughly as cfg.validation asks for.
+template <typename T, typename I>
+bool validate_witness(
+    Graph<T, I> &g,
+    Witness<T, I> &wit,
+    SSSPConfig &cfg,
+    size_t depth
 ) {
-    assert(g.is_restricted());
+    if(wit.state == UNKNOWN) return false;
 
-    // capper on recursion depth.
-    if(!cfg.capper -> incr()) return Witness<T>();
+    auto mode = depth == 0 ? cfg.validation.top_level : cfg.validation.inner_level;
+    if(mode == VALIDATE_NONE || wit.state != SHORTEST_PATH_TREE_FOUND) {
+        return mode == VALIDATE_NONE || wit.validate(g);
+    }
+    if(mode == VALIDATE_SPOT_CHECK) {
+        return spot_check_shortest_path_tree(
+            g,
+            wit.shortest_path_tree_witness,
+            cfg.validation.spot_check_samples,
+            cfg.validation.rng
+        );
+    }
+    return wit.validate(g, cfg.num_threads);
+}
 
-    cerr << "n = " << g.N() << ", kappa = " << kappa << '\n';
+// add_dag_potential shifts the potential of every scc of S by one offset, so that
+// every inter-component edge of g gets a non-negative reduced weight.
+// scc indices are a topological order of the DAG, so one pass over the
+// inter-component edges by target scc gives the largest such offsets,
+//     offset[C] = min(0, min over edges u -> v into C of offset[C(u)] + w(u, v)),
+// in O(n + m). Edges deleted before the decomposition are not considered.
+template <typename T, typename I>
+void add_dag_potential(Graph<T, I> &g, SCCDecomposition<T, I> &S) {
+    size_t nscc = S.num_scc();
+    vector<vector<size_t>> in_edges(nscc);
+    for(size_t edge_idx = 0, m = S.inter_scc.M(); edge_idx < m; edge_idx++) {
+        in_edges[S.vertex_down_map[S.inter_scc.edges[edge_idx].e].first].emplace_back(edge_idx);
+    }
 
-    // base case.
-    if(g.N() <= 1 || kappa <= LOW_KAPPA_LIMIT) {
-        auto wit = lazy_dijkstra::all_source(g, kappa, false, cfg.capper);
-        cerr << "small witness acquired\n";
-        // capper failure
-        if(cfg.capper ->fail()) return Witness<T>();
-        if( !validate_shortest_path_tree(g, wit) ) return Witness<T>();
-        cerr << "witness validated\n";
-        return make_witness_for_sptree(wit);
+    vector<T> offset(nscc, T(0));
+    for(size_t scc_idx = 0; scc_idx < nscc; scc_idx++) {
+        for(auto edge_idx : in_edges[scc_idx]) {
+            const auto &e = S.inter_scc.edges[edge_idx];
+            auto from = S.vertex_down_map[e.s].first;
+            assert(from < scc_idx);
+            offset[scc_idx] = min<T>(offset[scc_idx], offset[from] + g.get_weight(S.inter_scc.edge(edge_idx)));
+        }
+    }
+
+    for(size_t v_g = 0, n = g.N(); v_g < n; v_g++) {
+        g.phi.add(v_g, offset[S.vertex_down_map[v_g].first]);
+    }
+}
+
+// transpose_of returns the transpose of g. For a graph that is not an SCC (the top
+// level), it is kept in ws and reused while g keeps the same topology.
+template <typename T, typename I>
+Graph<T, I> &transpose_of(Graph<T, I> &g, Workspace<T, I> *ws, Graph<T, I> &local) {
+    if(ws == nullptr || g.is_scc) return local = g.transpose();
+
+    if(ws->transposed_topology != g.topology) {
+        ws->transposed = g.transpose();
+        ws->transposed_topology = g.topology;
+    } else {
+        g.refresh_transpose(ws->transposed);
     }
+    return ws->transposed;
+}
 
-    // recursion case.
+// carve_light_balls deletes from g the boundary edges of BCF23 ball carving:
+// balls of geometric radius around out-light vertices, then around in-light
+// vertices, each ball seeing the deletions of the previous ones.
+// g must have deletions enabled. Returns false if the capper ran out.
+template <typename T, typename I>
+bool carve_light_balls(
+    Graph<T, I> &g,
+    size_t kappa,
+    SSSPConfig &cfg,
+    Workspace<T, I> *ws = nullptr
+) {
     auto in_light_vertices = get_in_light_vertices(g, kappa, cfg);
-    if(cfg.capper -> fail()) return Witness<T>();
+    if(cfg.capper -> fail()) return false;
 
     cerr << "in_light_verts: "; for(auto inv : in_light_vertices) cerr << inv << ' '; cerr << '\n';
 
-    auto gt = g.transpose();
+    Graph<T, I> local_gt(0);
+    auto &gt = transpose_of(g, ws, local_gt);
     auto out_light_vertices = get_in_light_vertices(gt, kappa, cfg);
-    if(cfg.capper ->fail()) return Witness<T>();
+    if(cfg.capper ->fail()) return false;
 
     cerr << "out_light_verts: "; for(auto inv : out_light_vertices) cerr << inv << ' '; cerr << '\n';
 
     // initialize geometric sampler for radius
     geometric_distribution<T> radius_sampler(RADIUS_TEMPERATURE * log(g.N()) / kappa);
 
-    g.enable_dels();
     gt.enable_dels();
     for(auto v : out_light_vertices) {
         if(g.deleted_vertex(v)) continue;
 
         T r = radius_sampler(cfg.rng);
-        auto [ball, boundary] = naive_dijkstra::get_ball_and_boundary(g, v, r, cfg.capper);
+        auto [ball, boundary] = naive_dijkstra::get_ball_and_boundary(g, v, r, cfg.capper, ws);
 
         for(auto v : ball) {
             g.delete_vertex(v);
@@ -110,7 +177,7 @@ Witness<T> _solve_rsssp(
         if(g.deleted_vertex(v)) continue;
 
         T r = radius_sampler(cfg.rng);
-        auto [ball, boundary] = naive_dijkstra::get_ball_and_boundary(gt, v, r, cfg.capper);
+        auto [ball, boundary] = naive_dijkstra::get_ball_and_boundary(gt, v, r, cfg.capper, ws);
 
         for(auto v : ball) {
             g.delete_vertex(v);
@@ -123,94 +190,317 @@ Witness<T> _solve_rsssp(
         }
     }
 
-    cerr << "boundary removal done\n";
-
-    // scc decomposition with edges deleted.
     g.delv.clear();
-    gt.delv.clear();
-    SCCDecomposition<T> S(g);
+    return true;
+}
+
+// delete_shifted_cluster_boundary deletes from g the edges between the clusters of
+// an exponential start-time shift decomposition (Miller, Peng, Xu 2013).
+// Every vertex v draws delta_v ~ Exp(beta) and starts a search at time
+// max_delta - delta_v, and each vertex joins the cluster of the search reaching it
+// first. One multi-source delta stepping over cfg.num_threads grows all clusters at once.
+// With beta the rate of the ball radii, an edge of weight w is cut with probability
+// at most beta * (w + 1) (the +1 is from rounding start times), as for the balls.
+// Like balls, clusters grow along non-negative edges only.
+// g must have deletions enabled. Returns false if the capper ran out.
+template <typename T, typename I>
+bool delete_shifted_cluster_boundary(
+    Graph<T, I> &g,
+    size_t kappa,
+    SSSPConfig &cfg
+) {
+    size_t n = g.N();
+    exponential_distribution<long double> shift_sampler(RADIUS_TEMPERATURE * log(n) / kappa);
+
+    vector<long double> shift(n);
+    for(auto &x : shift) x = shift_sampler(cfg.rng);
+    long double max_shift = *max_element(shift.begin(), shift.end());
+
+    vector<size_t> src(n);
+    vector<T> start(n);
+    for(size_t v = 0; v < n; v++) {
+        src[v] = v;
+        // rounded up, so only the first real start wins a tie at time 0.
+        start[v] = T(ceil(max_shift - shift[v]));
+    }
+
+    auto wit = delta_stepping::multi_source(g, src, true, cfg.capper, cfg.num_threads, T(0), start);
+    if(cfg.capper -> fail()) return false;
+
+    // cluster of v: the root of its tree, found by walking up with memoization.
+    vector<I> cluster(n, I(-1));
+    vector<size_t> path;
+    for(size_t v = 0; v < n; v++) {
+        size_t x = v;
+        while(cluster[x] == I(-1) && wit.parent_edge_idx[x] != I(-1)) {
+            path.emplace_back(x);
+            x = g.edges[wit.parent_edge_idx[x]].s;
+        }
+        if(cluster[x] == I(-1)) cluster[x] = x;
+        for(auto y : path) cluster[y] = cluster[x];
+        path.clear();
+    }
+
+    for(size_t edge_idx = 0, m = g.M(); edge_idx < m; edge_idx++) {
+        const auto &e = g.edges[edge_idx];
+        if(cluster[e.s] != cluster[e.e]) g.delete_edge(edge_idx);
+    }
+    return true;
+}
+
+// internal function to solve rsssp.
+// depth: recursion depth, 0 for the top level. Decides the validation mode.
+// ws: scratch space shared by every level, optional.
+template <typename T, typename I>
+Witness<T, I> _solve_rsssp(
+    Graph<T, I> &g,
+    size_t kappa,
+    SSSPConfig &cfg,
+    size_t depth = 0,
+    Workspace<T, I> *ws = nullptr
+) {
+    assert(g.is_restricted());
+
+    // capper on recursion depth.
+    if(!cfg.capper -> incr()) return Witness<T, I>();
+
+    cerr << "n = " << g.N() << ", kappa = " << kappa << '\n';
+
+    // base case.
+    if(g.N() <= 1 || kappa <= LOW_KAPPA_LIMIT) {
+        NegativeCycleWitness cycle;
+        auto wit = lazy_dijkstra::all_source(g, kappa, false, cfg.capper, &cycle, ws);
+        cerr << "small witness acquired\n";
+        // capper failure
+        if(cfg.capper ->fail()) return Witness<T, I>();
+        Witness<T, I> witness = cycle.empty() ? make_witness_for_sptree(wit) : make_witness_for_negative_cycle<T, I>(cycle);
+        if( !validate_witness(g, witness, cfg, depth) ) return Witness<T, I>();
+        cerr << "witness validated\n";
+        return witness;
+    }
+
+    // recursion case. With cfg.split_sccs_first, a graph that is not strongly connected
+    // is split along its own SCCs: each is solved with the same kappa, and as an SCC it
+    // is carved at the next level, so the recursion stays bounded. The SCCs depend on
+    // the topology only, so the scaling rounds find them once.
+    // Otherwise cut g into pieces of small diameter, or of few vertices.
+    const GraphTopology<I> *topology = cfg.split_sccs_first && !g.is_scc ? &scc_topology(g) : nullptr;
+    bool presplit = topology != nullptr && topology->num_scc > 1;
+    if(!presplit) {
+        g.enable_dels();
+        bool carved = cfg.decomposition == DECOMPOSE_SHIFTED
+            ? delete_shifted_cluster_boundary(g, kappa, cfg)
+            : carve_light_balls(g, kappa, cfg, ws);
+        if(!carved) return Witness<T, I>();
+
+        cerr << "boundary removal done\n";
+    }
+
+    // scc decomposition with edges deleted, or the one of the topology.
+    SCCDecomposition<T, I> S = presplit ? SCCDecomposition<T, I>(g, *topology) : SCCDecomposition<T, I>(g);
 
     cerr << "scc decomposition done, n_scc = " << S.num_scc() << '\n';;
 
-    vector<Witness<T>> witness_by_scc;
-    for(auto &scc : S.scc_subgraphs) {
+    vector<Witness<T, I>> witness_by_scc;
+    for(size_t scc_idx = 0, nscc = S.num_scc(); scc_idx < nscc; scc_idx++) {
+        auto &scc = S.scc_subgraphs[scc_idx];
         cerr << "scc size is " << scc.N() << '\n';
-        // Case 1 : n decays.
-        if(scc.N() <= LIGHT_RATIO * g.N()) {
-            cerr << "case 1: small n\n";
-            Witness<T> witness = _solve_rsssp(scc, kappa, cfg);
-            cerr << "witness received with state = " << witness.state << "\n";
-            if( cfg.capper -> fail() || !witness.validate(scc) ) {
-                return Witness<T>();
+
+        Witness<T, I> witness;
+        T min_weight = scc.get_min_edge_weight();
+
+        // trivial components need no recursion: zero potential is already a solution
+        // when no edge is negative, and a singleton only has self-loops.
+        if(scc.N() == 1 || min_weight >= T(0)) {
+            witness = make_witness_for_sptree(ShortestPathTreeWitnessV2<T, I>(scc.N()));
+            for(size_t edge_idx = 0, m = scc.M(); edge_idx < m && min_weight < T(0); edge_idx++) {
+                if(scc.get_weight(edge_idx) < T(0)) {
+                    witness = make_witness_for_negative_cycle<T, I>(NegativeCycleWitness({edge_idx}));
+                    break;
+                }
+            }
+        } else {
+            // recurse on the scc with its chains contracted, if there are any.
+            auto contraction = contract_chains(scc);
+            bool contracted = contraction.graph.N() < scc.N();
+            auto &h = contracted ? contraction.graph : scc;
+            if(contracted) cerr << "contracted scc to size " << h.N() << '\n';
+
+            // Case 1 : n decays, or g was split without carving.
+            if(presplit || scc.N() <= LIGHT_RATIO * g.N()) {
+                cerr << "case 1: small n\n";
+                witness = _solve_rsssp(h, kappa, cfg, depth + 1, ws);
+                cerr << "witness received with state = " << witness.state << "\n";
+            } 
+            // Case 2 : kappa decays.
+            else {
+                cerr << "case 2: small kappa\n";
+                witness = _solve_rsssp(h, kappa / 2, cfg, depth + 1, ws);
             }
-            witness_by_scc.emplace_back(witness);
-        } 
-        // Case 2 : kappa decays.
-        else {
-            cerr << "case 2: small kappa\n";
-            Witness<T> witness = _solve_rsssp(scc, kappa / 2, cfg);
-            if( cfg.capper -> fail() || !witness.validate(scc) ) {
-                return Witness<T>();
+
+            if(contracted && witness.state != UNKNOWN) witness = contraction.lift(scc, witness);
+        }
+
+        // already validated by the callee
+        if( cfg.capper -> fail() ) {
+            return Witness<T, I>();
+        }
+
+        // a negative cycle in the scc is one in g: lift it to edge indices of g.
+        if( witness.state == NEGATIVE_CYCLE_FOUND ) {
+            for(auto &edge_idx : witness.negative_cycle_witness) {
+                edge_idx = S.edge_up_map[scc_idx][edge_idx];
             }
-            witness_by_scc.emplace_back(witness);
+            return witness;
         }
+
+        // the callee gave up within budget (unlucky sampling, or a negative cycle it
+        // could not pin down). Use zero potential for this scc instead: the final
+        // lazy dijkstra below is unbounded, so it either fixes it or finds the cycle.
+        if( witness.state != SHORTEST_PATH_TREE_FOUND ) {
+            witness = make_witness_for_sptree(ShortestPathTreeWitnessV2<T, I>(scc.N()));
+        }
+
+        witness_by_scc.emplace_back(witness);
     }
 
-    // update intra-SCC potential of g
+    // update intra-SCC potential of g.
+    // The callee solved scc in place: its solution potential is scc.phi + dist.
     g.disable_dels();
     for(
         size_t scc_idx = 0, nscc = S.num_scc(); 
         scc_idx < nscc;
         scc_idx++
     ) {
-        Witness<T> &wit = witness_by_scc[scc_idx];
+        Witness<T, I> &wit = witness_by_scc[scc_idx];
+        auto &scc = S.scc_subgraphs[scc_idx];
+        const auto &scc_phi = as_const(scc.phi);
         for(
-            size_t v_scc = 0, n = S.scc_subgraphs[scc_idx].N();
+            size_t v_scc = 0, n = scc.N();
             v_scc < n;
             v_scc++
         ) {
             size_t v_g = S.vertex_up_map[scc_idx][v_scc];
-            g.phi[v_g] += wit.shortest_path_tree_witness.dist[v_scc];
+            g.phi.add(v_g, scc_phi[v_scc] + wit.shortest_path_tree_witness.dist[v_scc]);
         }
     }
 
     // update DAG-potential of g
-    for(
-        size_t v_g = 0, n = g.N();
-        v_g < n;
-        v_g++
-    ) {
-        auto scc_idx = S.vertex_down_map[v_g].first;
-        g.phi[v_g] -= T(scc_idx);
-    }
+    add_dag_potential(g, S);
 
     cerr << "potential adjusted\n";
     for(int i = 0; i < g.N(); i++) cerr << g.phi[i] << ' '; cerr << '\n';
 
-    // lazy dijkstra with unlimited kappa. cap by capper
+    // lazy dijkstra with unlimited kappa. cap by capper, stop on a negative cycle.
+    // Most vertices are already settled by the potential: seed only the ones that can improve.
+    NegativeCycleWitness cycle;
     auto dist = lazy_dijkstra::artificial_source(
         g,
         size_t(-1),
         false,
-        cfg.capper
+        cfg.capper,
+        &cycle,
+        ws,
+        true
     );
 
     cerr << "concur step done\n";
 
-    Witness<T> witness = make_witness_for_sptree(dist);
+    Witness<T, I> witness = cycle.empty() ? make_witness_for_sptree(dist) : make_witness_for_negative_cycle<T, I>(cycle);
 
-    if(cfg.capper -> fail() || !witness.validate(g)) {
-        return Witness<T>();
+    if(cfg.capper -> fail() || !validate_witness(g, witness, cfg, depth)) {
+        return Witness<T, I>();
     }
 
     return witness;
 }
 
-template <typename T>
-Witness<T> solve_rsssp(Graph<T> &g, SSSPConfig &cfg) {
+// ws: optional scratch space, kept by the caller across calls.
+template <typename T, typename I>
+Witness<T, I> solve_rsssp(Graph<T, I> &g, SSSPConfig &cfg, Workspace<T, I> *ws = nullptr) {
+    // one workspace for every level, so ball carving never allocates per ball.
+    Workspace<T, I> local_ws;
+    if(ws == nullptr) ws = &local_ws;
+
     return _solve_rsssp(
         g,
         g.N(),
-        cfg
+        cfg,
+        0,
+        ws
     );
+}
+
+namespace internal {
+    // fits_weight_type tells whether the restricted solver can run on g with weights,
+    // potentials and distances stored as N: (n + 1) * (largest magnitude + 1) must
+    // stay 64 times below its maximum, as potentials add up over the recursion levels.
+    template <typename N, typename T, typename I>
+    bool fits_weight_type(Graph<T, I> &g) {
+        if constexpr(!is_integral_v<T> || sizeof(N) >= sizeof(T)) {
+            return false;
+        } else {
+            T largest = 0;
+            for(auto w : g.soa.w) largest = max<T>(largest, w < 0 ? -w : w);
+            for(auto p : as_const(g.phi)) largest = max<T>(largest, p < 0 ? -p : p);
+            T limit = T(numeric_limits<N>::max() / 64) / T(g.N() + 1);
+            return largest < limit;
+        }
+    }
+
+    // solve_rsssp_as solves g through a copy with weight type N, and translates the
+    // witness back. The copy's answer is validated on g itself, so an overflow in N
+    // cannot pass; g is then solved as is, as it is when the copy ends UNKNOWN with
+    // budget left. The copy runs on ws->narrow<N>(), kept by the caller across rounds.
+    template <typename N, typename T, typename I>
+    Witness<T, I> solve_rsssp_as(Graph<T, I> &g, SSSPConfig &cfg, Workspace<T, I> *ws) {
+        Workspace<T, I> local_ws;
+        if(ws == nullptr) ws = &local_ws;
+
+        Graph<N, I> h = with_weight_type<N>(g);
+        auto narrow = solve_rsssp(h, cfg, &ws->template narrow<N>());
+        if(narrow.state == UNKNOWN) {
+            if(cfg.capper -> fail()) return Witness<T, I>();
+            cerr << "narrow solve gave up, solving with the full weight type\n";
+            return solve_rsssp(g, cfg, ws);
+        }
+
+        Witness<T, I> wit;
+        wit.state = narrow.state;
+        wit.negative_cycle_witness = move(narrow.negative_cycle_witness);
+        if(wit.state == SHORTEST_PATH_TREE_FOUND) {
+            const auto &from = narrow.shortest_path_tree_witness;
+            auto &to = wit.shortest_path_tree_witness;
+            to.parent_edge_idx = move(narrow.shortest_path_tree_witness.parent_edge_idx);
+            to.dist.resize(from.dist.size());
+            for(size_t v = 0; v < from.dist.size(); v++) {
+                to.dist[v] = from.dist[v] == numeric_limits<N>::max() ? numeric_limits<T>::max() : T(from.dist[v]);
+            }
+        }
+
+        // solved in place, as solve_rsssp would have; the distances are relative to it.
+        vector<T> old_phi = as_const(g.phi);
+        const auto &phi = as_const(h.phi);
+        T *out = g.phi.mutable_data();
+        for(size_t v = 0, n = g.N(); v < n; v++) out[v] = T(phi[v]);
+        g.phi.touch();
+
+        if(!wit.validate(g, cfg.num_threads)) {
+            cerr << "narrow witness rejected, solving with the full weight type\n";
+            g.phi = old_phi;
+            return solve_rsssp(g, cfg, ws);
+        }
+        return wit;
+    }
+}
+
+// solve_rsssp_narrow is solve_rsssp with weights stored in the narrowest of int16_t and
+// int32_t that the weights and potential of g allow (see internal::fits_weight_type),
+// so the hot loops read less memory. Distances are returned as T. Falls back to
+// solve_rsssp if neither fits or T is not wider.
+template <typename T, typename I>
+Witness<T, I> solve_rsssp_narrow(Graph<T, I> &g, SSSPConfig &cfg, Workspace<T, I> *ws = nullptr) {
+    if(internal::fits_weight_type<int16_t>(g)) return internal::solve_rsssp_as<int16_t>(g, cfg, ws);
+    if(internal::fits_weight_type<int32_t>(g)) return internal::solve_rsssp_as<int32_t>(g, cfg, ws);
+    return solve_rsssp(g, cfg, ws);
 }
\ No newline at end of file
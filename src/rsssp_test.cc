@@ -26,7 +26,7 @@ TEST_CASE("minimal example of restricted graph", "[rsssp]") {
     }));
 }
 
-TEST_CASE("should fail on negative cycle", "[rsssp]") {
+TEST_CASE("should find negative cycle", "[rsssp]") {
     Graph<int> g(3);
 
     g.add_edge({0, 1, 0});
@@ -35,12 +35,13 @@ TEST_CASE("should fail on negative cycle", "[rsssp]") {
 
     g.is_scc = true;
 
-    SSSPConfig cfg(200);
+    SSSPConfig cfg(2000);
     Witness<int> w = solve_rsssp(g, cfg);
 
-    REQUIRE_FALSE( w.validate(g) );
-    REQUIRE( w.state == UNKNOWN );
-    REQUIRE( cfg.capper -> fail() );
+    REQUIRE( w.state == NEGATIVE_CYCLE_FOUND );
+    REQUIRE( w.validate(g) );
+    REQUIRE( w.negative_cycle_witness.size() == 3 );
+    REQUIRE_FALSE( cfg.capper -> fail() );
 }
 
 // gen_path makes random path graph with random weight.
@@ -108,4 +109,104 @@ TEST_CASE("simple but big case - wheel", "[rsssp]") {
 
     REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
     REQUIRE( wit.validate(g) );
+}
+
+TEST_CASE("wheel with shifted clustering", "[rsssp]") {
+    const size_t n = 15;
+
+    for(size_t threads : {1, 3}) {
+        Graph<int> g = gen_wheel(n);
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.decomposition = DECOMPOSE_SHIFTED;
+        cfg.num_threads = threads;
+
+        Witness<int> wit = solve_rsssp(g, cfg);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.validate(g) );
+    }
+}
+
+TEST_CASE("shifted clustering only cuts between clusters", "[rsssp]") {
+    // a heavy cycle: with kappa large, shifts are small against the weights,
+    // so every vertex is its own cluster and every edge is cut.
+    Graph<int> g(4);
+    for(size_t v = 0; v < 4; v++) g.add_edge(Edge<int>({v, (v + 1) % 4, 1000}));
+    g.add_edge(Edge<int>({2, 2, 5}));
+
+    SSSPConfig cfg(size_t(-1));
+    g.enable_dels();
+    REQUIRE( delete_shifted_cluster_boundary(g, 4, cfg) );
+    for(size_t edge_idx = 0; edge_idx < 4; edge_idx++) REQUIRE( g.deleted_edge(edge_idx) );
+    REQUIRE_FALSE( g.deleted_edge(4) );
+
+    // zero weights: one cluster, nothing is cut.
+    Graph<int> h(4);
+    for(size_t v = 0; v < 4; v++) h.add_edge(Edge<int>({v, (v + 1) % 4, 0}));
+    h.enable_dels();
+    REQUIRE( delete_shifted_cluster_boundary(h, 4, cfg) );
+    for(size_t edge_idx = 0; edge_idx < 4; edge_idx++) REQUIRE_FALSE( h.deleted_edge(edge_idx) );
+}
+
+TEST_CASE("dag potential makes inter-component edges non-negative", "[rsssp]") {
+    // sccs {0, 1} and {2, 3}, and singletons 4 and 5.
+    Graph<int> g(6);
+    g.add_edge({0, 1, 0});
+    g.add_edge({1, 0, 0});
+    g.add_edge({2, 3, 0});
+    g.add_edge({3, 2, 0});
+    g.add_edge({0, 2, -1});
+    g.add_edge({1, 4, -1});
+    g.add_edge({4, 3, -1});
+    g.add_edge({3, 5, -1});
+
+    SCCDecomposition<int> S(g);
+    add_dag_potential(g, S);
+
+    for(size_t edge_idx = 0; edge_idx < g.M(); edge_idx++) REQUIRE( g.get_weight(edge_idx) >= 0 );
+    // shortest paths from the source component, clipped at 0.
+    REQUIRE( g.phi[0] == g.phi[1] );
+    REQUIRE( g.phi[2] == g.phi[3] );
+    REQUIRE( g.phi[4] == -1 );
+    REQUIRE( g.phi[2] == -2 );
+    REQUIRE( g.phi[5] == -3 );
+}
+
+TEST_CASE("transpose is kept per topology", "[rsssp]") {
+    Graph<int> g(4);
+    g.add_edge({0, 1, 3});
+    g.add_edge({1, 2, -2});
+    g.add_edge({2, 3, 5});
+    g.add_edge({3, 0, 1});
+    g.phi = vector<int>({0, 1, 2, 3});
+
+    Workspace<int> ws;
+    Graph<int> local(0);
+    auto &first = transpose_of(g, &ws, local);
+    REQUIRE( &first == &ws.transposed );
+    REQUIRE( first.edge_list() == g.transpose().edge_list() );
+
+    // a copy with other weights, potential and deletions reuses it.
+    Graph<int> h = g;
+    h.scale_weights(4);
+    h.phi.set(2, -7);
+    h.enable_dels();
+    h.delete_edge(1);
+    auto &second = transpose_of(h, &ws, local);
+    REQUIRE( &second == &first );
+    auto expected = h.transpose();
+    REQUIRE( second.edge_list() == expected.edge_list() );
+    REQUIRE( second.adj == expected.adj );
+    REQUIRE( second.deleted_edge(1) );
+    for(size_t edge_idx = 0; edge_idx < h.M(); edge_idx++) {
+        REQUIRE( second.get_weight(edge_idx) == expected.get_weight(edge_idx) );
+    }
+
+    // SCCs and structural edits are not cached.
+    g.is_scc = true;
+    REQUIRE( &transpose_of(g, &ws, local) == &local );
+    g.is_scc = false;
+    g.add_edge({0, 2, 1});
+    REQUIRE( transpose_of(g, &ws, local).M() == 5 );
 }
\ No newline at end of file
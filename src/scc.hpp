@@ -1,59 +1,83 @@
 #pragma once
 // makes scc from a graph.
 #include "graph.hpp"
+#include <algorithm>
+#include <functional>
 #include <vector>
 #include <iostream>
 
 using namespace std;
-using SCCIndex = pair<size_t, size_t>; // (scc idx, idx of vertex in scc)
+template <typename I = size_t>
+using SCCIndexOf = pair<I, I>; // (scc idx, idx of vertex in scc)
+using SCCIndex = SCCIndexOf<size_t>;
 
 constexpr SCCIndex INVALID_SCC_INDEX = SCCIndex(-1, -1);
 
-template <typename T>
+// I: index type of g, see Edge.
+template <typename T, typename I = size_t>
 struct SCCDecomposition {
-    Graph<T> &g;
+    using Index = SCCIndexOf<I>;
+    static constexpr Index INVALID_INDEX = Index(I(-1), I(-1));
+
+    Graph<T, I> &g;
 
     // DAG storing inter-component edges only.
-    Graph<T> inter_scc;
+    Graph<T, I> inter_scc;
     // subgraphs for each SCC.
-    vector<Graph<T>> scc_subgraphs;
+    vector<Graph<T, I>> scc_subgraphs;
     // subgraph vertex index -> original vertex index
-    vector<vector<size_t>> vertex_up_map;
-    vector<vector<size_t>> edge_up_map;
+    vector<vector<I>> vertex_up_map;
+    // subgraph edge index -> original edge index
+    vector<vector<I>> edge_up_map;
 
     // original vertex index -> (subgraph index, subgraph vertex index)
-    vector<SCCIndex> vertex_down_map; // size: n
-    vector<size_t> edge_down_map; // size: m
+    vector<Index> vertex_down_map; // size: n
+    vector<I> edge_down_map; // size: m, I(-1) for deleted edges
 
-    SCCDecomposition(Graph<T> &_g) : g(_g), inter_scc(_g.N()) {
+    SCCDecomposition(Graph<T, I> &_g) : g(_g), inter_scc(_g.N()) {
         _decompose();
     }
 
+    // decomposition along SCCs already known, e.g. scc_topology(g). g must have no
+    // deletions: the components are not searched again.
+    SCCDecomposition(Graph<T, I> &_g, const GraphTopology<I> &topology) : g(_g), inter_scc(_g.N()) {
+        vertex_down_map.resize(g.N(), INVALID_INDEX);
+        for(size_t scc_idx = 0; scc_idx < topology.num_scc; scc_idx++) {
+            _add_scc();
+            for(size_t k = topology.scc_begin[scc_idx]; k < topology.scc_begin[scc_idx + 1]; k++) {
+                size_t v = topology.scc_order[k];
+                vertex_down_map[v] = _add_scc_vertex(v, scc_idx);
+                scc_subgraphs[scc_idx].add_vertex(T(0));
+            }
+        }
+        _project_edges();
+    }
+
     size_t num_scc() {
         return scc_subgraphs.size();
     }
 
     // utility function to add a vertex into given scc group.
-    SCCIndex _add_scc_vertex(size_t v, size_t scc_idx) {
+    Index _add_scc_vertex(size_t v, size_t scc_idx) {
         vertex_up_map[scc_idx].emplace_back(v);
-        return SCCIndex(scc_idx, vertex_up_map[scc_idx].size() - 1);
+        return Index(scc_idx, vertex_up_map[scc_idx].size() - 1);
     }
 
     bool in_same_scc(size_t v1, size_t v2) {
         return vertex_down_map[v1].first == vertex_down_map[v2].first;
     }
 
-    SCCIndex get_edge_index(size_t edge_idx) {
+    Index get_edge_index(size_t edge_idx) {
         auto edge = g.edges[edge_idx];
-        if( in_same_scc(edge.s, edge.e) ) return SCCIndex(vertex_down_map[edge.s].first, edge_down_map[edge_idx]);
-        else return SCCIndex(INVALID_SCC_INDEX.first, edge_down_map[edge_idx]);
+        if( in_same_scc(edge.s, edge.e) ) return Index(vertex_down_map[edge.s].first, edge_down_map[edge_idx]);
+        else return Index(INVALID_INDEX.first, edge_down_map[edge_idx]);
     }
 
     void _decompose() {
         auto n = g.N();
 
         // Initialize scc-related variables
-        vertex_down_map.resize(n, INVALID_SCC_INDEX);
+        vertex_down_map.resize(n, INVALID_INDEX);
         size_t last_scc_idx = 0;
 
         // Kosaraju's algorithm for SCC
@@ -88,7 +112,7 @@ struct SCCDecomposition {
 
                 if(g.deleted_vertex(y)) continue;
                 
-                if(vertex_down_map[y] != INVALID_SCC_INDEX) continue;
+                if(vertex_down_map[y] != INVALID_INDEX) continue;
                 assign_scc(y);
             }
         };
@@ -101,15 +125,27 @@ struct SCCDecomposition {
         reverse(ft.begin(), ft.end());
 
         for(int i : ft) {
-            if(g.deleted_vertex(i) || vertex_down_map[i] != INVALID_SCC_INDEX) continue;
+            if(g.deleted_vertex(i) || vertex_down_map[i] != INVALID_INDEX) continue;
             
-            // assign new scc subgraph and inverse mapping
-            scc_subgraphs.emplace_back(0, true);
-            vertex_up_map.emplace_back();
+            _add_scc();
             assign_scc(i);
             ++last_scc_idx;
         }
 
+        _project_edges();
+    }
+
+    // assign new scc subgraph and inverse mapping
+    void _add_scc() {
+        scc_subgraphs.emplace_back(0, true);
+        scc_subgraphs.back().cache_reduced_weights = g.cache_reduced_weights;
+        vertex_up_map.emplace_back();
+        edge_up_map.emplace_back();
+    }
+
+    // splits the edges of g into scc subgraphs and inter_scc, once vertices are assigned.
+    void _project_edges() {
+        edge_down_map.resize(g.M(), I(-1));
         for(size_t edge_idx = 0, m = g.M(); edge_idx < m; edge_idx++) {
             if(g.deleted_edge(edge_idx)) continue;
             auto edge = g.edges[edge_idx];
@@ -123,15 +159,39 @@ struct SCCDecomposition {
                     {
                         vertex_down_map[edge.s].second,
                         vertex_down_map[edge.e].second,
-                        edge.w
+                        g.weight(edge_idx)
                     }
                 );
 
-                edge_down_map.emplace_back(scc_subgraphs[scc_idx].M() - 1);
+                edge_down_map[edge_idx] = scc_subgraphs[scc_idx].M() - 1;
+                edge_up_map[scc_idx].emplace_back(edge_idx);
             } else {
-                inter_scc.add_edge(edge);
-                edge_down_map.emplace_back(inter_scc.M() - 1);
+                inter_scc.add_edge(g.edge(edge_idx));
+                edge_down_map[edge_idx] = inter_scc.M() - 1;
             }
         }
     }
-};
\ No newline at end of file
+};
+
+// scc_topology returns the SCCs of g with deletions ignored. They are computed once
+// per topology: copies of g share them until either copy is structurally edited.
+template <typename T, typename I>
+const GraphTopology<I> &scc_topology(Graph<T, I> &g) {
+    auto &topology = *g.topology;
+    call_once(topology.once, [&]() {
+        // deletions are kept, only hidden while decomposing.
+        bool use_dels = g.use_dels;
+        g.use_dels = false;
+        SCCDecomposition<T, I> S(g);
+        g.use_dels = use_dels;
+
+        topology.num_scc = S.num_scc();
+        topology.scc_begin.emplace_back(0);
+        for(auto &up : S.vertex_up_map) {
+            topology.scc_order.insert(topology.scc_order.end(), up.begin(), up.end());
+            topology.scc_begin.emplace_back(topology.scc_order.size());
+        }
+        topology.filled.store(true);
+    });
+    return topology;
+}
\ No newline at end of file
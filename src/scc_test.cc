@@ -1,6 +1,7 @@
 #include "scc.hpp"
 #include "graph.hpp"
 #include "catch2/catch_all.hpp"
+#include <thread>
 
 using namespace std;
 
@@ -64,4 +65,90 @@ TEST_CASE("scc for test", "[scc]") {
     // validate get_edge_index
     REQUIRE(S.get_edge_index(0) == SCCIndex(1, 0));
     REQUIRE(S.get_edge_index(8) == SCCIndex(-1, 2));
+}
+
+TEST_CASE("scc with 32-bit indices", "[scc]") {
+    Graph<int, uint32_t> g(7);
+
+    g.add_edge({0, 1, 0});
+    g.add_edge({1, 2, 0});
+    g.add_edge({2, 0, 0});
+    g.add_edge({5, 4, 0});
+    g.add_edge({4, 3, 0});
+    g.add_edge({3, 5, 0});
+    g.add_edge({1, 3, 0});
+    g.add_edge({1, 4, 0});
+    g.add_edge({0, 5, 0});
+
+    SCCDecomposition<int, uint32_t> S(g);
+
+    REQUIRE(S.num_scc() == 3);
+
+    auto expected_scc_indices = vector<SCCIndexOf<uint32_t>>({
+        {1, 0},
+        {1, 2},
+        {1, 1},
+        {2, 0},
+        {2, 1},
+        {2, 2},
+        {0, 0},
+    });
+
+    REQUIRE( expected_scc_indices == S.vertex_down_map );
+    REQUIRE( S.get_edge_index(8) == SCCIndexOf<uint32_t>(uint32_t(-1), 2) );
+    REQUIRE( S.edge_up_map[1] == vector<uint32_t>({0, 1, 2}) );
+}
+
+TEST_CASE("scc topology is shared by copies", "[scc]") {
+    Graph<int> g(7);
+    g.add_edge({0, 1, 0});
+    g.add_edge({1, 2, 0});
+    g.add_edge({2, 0, 0});
+    g.add_edge({5, 4, 0});
+    g.add_edge({4, 3, 0});
+    g.add_edge({3, 5, 0});
+    g.add_edge({1, 3, 0});
+    g.add_edge({1, 4, 0});
+    g.add_edge({0, 5, 0});
+
+    // a copy with other weights and deletions fills the cache of g.
+    Graph<int> h = g;
+    h.ceil_div_weights(2, 1);
+    h.enable_dels();
+    h.delete_edge(0);
+    const auto &topology = scc_topology(h);
+    REQUIRE( g.topology.get() == &topology );
+    REQUIRE( topology.num_scc == 3 );
+    REQUIRE( h.deleted_edge(0) );
+
+    // same decomposition as Kosaraju's.
+    SCCDecomposition<int> S(g), T(g, topology);
+    REQUIRE( S.vertex_down_map == T.vertex_down_map );
+    REQUIRE( S.vertex_up_map == T.vertex_up_map );
+    REQUIRE( S.edge_down_map == T.edge_down_map );
+    REQUIRE( S.inter_scc.M() == T.inter_scc.M() );
+
+    // a structural edit detaches the cache.
+    h.add_edge({5, 0, 0});
+    REQUIRE( h.topology != g.topology );
+    REQUIRE( scc_topology(h).num_scc == 2 );
+    REQUIRE( scc_topology(g).num_scc == 3 );
+
+    SECTION("copies edited while another thread fills the cache") {
+        Graph<int> fresh(0);
+        for(size_t v = 0; v < g.N(); v++) fresh.add_vertex();
+        for(size_t edge_idx = 0; edge_idx < g.M(); edge_idx++) fresh.add_edge(g.edge(edge_idx));
+
+        vector<Graph<int>> copies(4, fresh);
+        vector<size_t> num_scc(copies.size());
+        vector<thread> threads;
+        for(size_t t = 0; t < copies.size(); t++) {
+            threads.emplace_back([&, t]() {
+                if(t % 2) copies[t].add_edge({5, 0, 0});
+                num_scc[t] = scc_topology(copies[t]).num_scc;
+            });
+        }
+        for(auto &th : threads) th.join();
+        for(size_t t = 0; t < copies.size(); t++) REQUIRE( num_scc[t] == (t % 2 ? 2 : 3) );
+    }
 }
\ No newline at end of file
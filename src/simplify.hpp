@@ -0,0 +1,62 @@
+// Multigraph simplification.
+// Of the parallel edges s -> e only one of minimum weight can be on a shortest path,
+// and a self-loop is either useless (w >= 0) or a negative cycle by itself.
+// Simplifying once saves every later pass (scaling, scc, dijkstras) the redundant edges.
+#pragma once
+#include "graph.hpp"
+#include "reorder.hpp"
+#include "spresult.hpp"
+#include <vector>
+
+using namespace std;
+
+// simplify keeps, for every ordered pair (s, e), one edge of minimum weight (the first
+// one in input order on ties), and drops self-loops. Vertices keep their labels, and
+// edge_up_map of the result maps the kept edges back to g.
+// negative_self_loop: if given, receives one negative self-loop of g (a negative cycle
+// of one edge), or stays empty. The loop is dropped from the result either way.
+// Deleted vertices and edges are not supported.
+template <typename T, typename I>
+ReorderedGraph<T, I> simplify(Graph<T, I> &g, NegativeCycleWitness *negative_self_loop = nullptr) {
+    size_t n = g.N();
+
+    ReorderedGraph<T, I> r;
+    r.vertex_down_map.resize(n);
+    r.vertex_up_map.resize(n);
+    iota(r.vertex_down_map.begin(), r.vertex_down_map.end(), 0);
+    iota(r.vertex_up_map.begin(), r.vertex_up_map.end(), 0);
+
+    Graph<T, I> &h = r.graph;
+    h.is_scc = g.is_scc;
+    h.potential_mult = g.potential_mult;
+    h.cache_reduced_weights = g.cache_reduced_weights;
+    for(auto phi : as_const(g.phi)) h.add_vertex(phi);
+
+    // best[e]: the kept edge into e among the out-edges of the current source.
+    // Only the targets of the current source are reset, so the pass is O(n + m).
+    vector<I> best(n, I(-1));
+    vector<size_t> targets;
+    for(size_t s = 0; s < n; s++) {
+        for(auto edge_idx : g.adj[s]) {
+            const auto &e = g.edges[edge_idx];
+            if(e.e == s) {
+                if(g.weight(edge_idx) < T(0) && negative_self_loop != nullptr && negative_self_loop->empty()) {
+                    negative_self_loop->emplace_back(edge_idx);
+                }
+                continue;
+            }
+            if(best[e.e] == I(-1)) targets.emplace_back(e.e);
+            if(best[e.e] == I(-1) || g.weight(edge_idx) < g.weight(best[e.e])) best[e.e] = edge_idx;
+        }
+
+        for(auto x : targets) {
+            if(best[x] == I(-1)) continue;
+            r.edge_up_map.emplace_back(best[x]);
+            h.add_edge(g.edge(best[x]));
+            best[x] = I(-1);
+        }
+        targets.clear();
+    }
+
+    return r;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "simplify.hpp"
+#include "sssp.hpp"
+#include "catch2/catch_all.hpp"
+
+TEST_CASE("simplify keeps the lightest parallel edge", "[simplify]") {
+    Graph<int> g(3);
+    g.add_edge({0, 1, 5});  // 0
+    g.add_edge({0, 1, 2});  // 1
+    g.add_edge({0, 1, 2});  // 2, tie: the first one stays
+    g.add_edge({1, 1, 4});  // 3, self-loop
+    g.add_edge({1, 2, -1}); // 4
+    g.add_edge({2, 0, 3});  // 5
+    g.add_edge({1, 0, 7});  // 6, other direction
+
+    NegativeCycleWitness self_loop;
+    auto r = simplify(g, &self_loop);
+
+    REQUIRE( self_loop.empty() );
+    REQUIRE( r.graph.N() == 3 );
+    REQUIRE( r.graph.M() == 4 );
+
+    vector<size_t> kept(r.edge_up_map.begin(), r.edge_up_map.end());
+    sort(kept.begin(), kept.end());
+    REQUIRE( kept == vector<size_t>({1, 4, 5, 6}) );
+    for(size_t edge_idx = 0; edge_idx < r.graph.M(); edge_idx++) {
+        auto e = r.graph.edge(edge_idx), o = g.edge(r.edge_up_map[edge_idx]);
+        REQUIRE( (e.s == o.s && e.e == o.e && e.w == o.w) );
+    }
+
+    g.add_edge({2, 2, -1}); // 7
+    simplify(g, &self_loop);
+    REQUIRE( self_loop == NegativeCycleWitness({7}) );
+}
+
+TEST_CASE("sssp on a simplified multigraph", "[simplify]") {
+    Graph<int> g(20);
+
+    mt19937 rng(0x4834);
+    uniform_int_distribution<int> v(0, 19), wt(-300, 20), copies(1, 5);
+
+    // every edge comes up to 5 times, with random weights, and with self-loops.
+    for(int i = 0; i < 30; i++) {
+        size_t a = v(rng), b = v(rng);
+        while(a == b) b = v(rng);
+        if(a > b) swap(a, b);
+
+        for(int c = copies(rng); c > 0; c--) g.add_edge(Edge<int>({a, b, wt(rng)}));
+        g.add_edge(Edge<int>({a, a, 10}));
+    }
+
+    SSSPConfig cfg(200000);
+    cfg.simplify_multigraph = true;
+
+    auto wit = sssp(g, 0, cfg);
+    auto bf = bellman_ford::single_source(g, 0);
+
+    REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( wit.validate(g) );
+    REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+
+    g.add_edge(Edge<int>({7, 7, -1}));
+    auto cyc = sssp(g, 0, cfg);
+    REQUIRE( cyc.state == NEGATIVE_CYCLE_FOUND );
+    REQUIRE( cyc.negative_cycle_witness == NegativeCycleWitness({g.M() - 1}) );
+}
\ No newline at end of file
@@ -1,66 +1,176 @@
 // Shortest Path algorithms.
-// includes dijkstra, bellman_ford and lazy_dijkstra (BCF23 original)
+// includes dijkstra, delta_stepping, bellman_ford and lazy_dijkstra (BCF23 original)
 #pragma once
 #include "graph.hpp"
 #include "spresult.hpp"
 #include "capper.hpp"
+#include "parallel.hpp"
+#include "workspace.hpp"
+#include <cstdint>
+#include <map>
 #include <numeric>
 #include <vector>
 
 using namespace std;
 
 namespace internal {
+    // DenseTree and WorkspaceTree give the dijkstra cores one interface to a shortest
+    // path tree: dist(v), parent(v) and set(v, d, parent_edge).
+    template <typename T, typename I>
+    struct DenseTree {
+        ShortestPathTreeWitnessV2<T, I> &wit;
+
+        T dist(size_t v) const { return wit.dist[v]; }
+        I parent(size_t v) const { return wit.parent_edge_idx[v]; }
+        void set(size_t v, T d, I parent_edge) {
+            wit.dist[v] = d;
+            wit.parent_edge_idx[v] = parent_edge;
+        }
+    };
+
+    // WorkspaceTree writes to the sparse tree of ws, and reads base for the vertices
+    // it did not write since ws.begin(). Write back with store() once done.
+    template <typename T, typename I>
+    struct WorkspaceTree {
+        Workspace<T, I> &ws;
+        const ShortestPathTreeWitnessV2<T, I> &base;
+
+        T dist(size_t v) const { return ws.dist.has(v) ? ws.dist.get(v) : base.dist[v]; }
+        I parent(size_t v) const { return ws.dist.has(v) ? ws.parent_edge_idx.get(v) : base.parent_edge_idx[v]; }
+        void set(size_t v, T d, I parent_edge) { ws.set(v, d, parent_edge); }
+
+        // copies the written vertices into wit, in O(written).
+        void store(ShortestPathTreeWitnessV2<T, I> &wit) const {
+            for(auto v : ws.touched) {
+                wit.dist[v] = ws.dist.get(v);
+                wit.parent_edge_idx[v] = ws.parent_edge_idx.get(v);
+            }
+        }
+    };
+
     // internal update function of dist map.
     // used by: dijkstra, lazy_dijkstra.
     // ignore negative edges by default.
-    template <typename T, typename PairT = pair<T, size_t>>
-    void relax_dijkstra_with_priority_queue(
-        Graph<T> &g,
-        priority_queue<PairT, vector<PairT>, greater<PairT>> &Q,
-        ShortestPathTreeWitnessV2<T> &wit,
-        OperationCapper *capper = nullptr
+    // Queue: a min-priority_queue of (dist, vertex), or a ReusableHeap.
+    // Tree: DenseTree or WorkspaceTree.
+    // settled: if given, receives every vertex scanned, once each.
+    template <typename T, typename I, typename Queue, typename Tree>
+    void relax_dijkstra_on_tree(
+        Graph<T, I> &g,
+        Queue &Q,
+        Tree &tree,
+        OperationCapper *capper = nullptr,
+        vector<size_t> *settled = nullptr
     ) {
         if(capper == nullptr) capper = new NoCapOperationCapper();
 
         if(!capper -> incr()) return;
 
+        ReducedWeightView<T, I> weight(g);
+
         while(!Q.empty()) {
             auto [current_dist, current_vertex] = Q.top();
             Q.pop();
 
-            if(current_dist != wit.dist[current_vertex]) continue;
+            if(current_dist != tree.dist(current_vertex)) continue;
+            // unreached vertex: nothing to relax, and dist + w would overflow
+            if(current_dist == numeric_limits<T>::max()) continue;
+            if(settled != nullptr) settled -> emplace_back(current_vertex);
             
             for(auto edge_idx : g.adj[current_vertex]) {
                 if(g.deleted_edge(edge_idx)) continue;
 
                 // skipped since edge is deleted
-                auto edge = g.edges[edge_idx];
+                T w = weight(edge_idx);
                 
                 // ignore negative edges
-                if(g.get_weight(edge) < T(0)) continue;
+                if(w < T(0)) continue;
                 
-                size_t next_vertex = edge.e;
+                size_t next_vertex = g.edges[edge_idx].e;
 
                 // skipped since next vertex is deleted
                 if(g.deleted_vertex(next_vertex)) continue;
                 
                 // skipped due to useless relzaxation
-                if(
-                    wit.dist[next_vertex] 
-                    <= wit.dist[current_vertex] + g.get_weight(edge)
-                ) continue;
+                T d = current_dist + w;
+                if(tree.dist(next_vertex) <= d) continue;
                 
                 // relax
-                wit.dist[next_vertex] = wit.dist[current_vertex] + g.get_weight(edge);
-                wit.parent_edge_idx[next_vertex] = edge_idx;
+                tree.set(next_vertex, d, edge_idx);
 
                 Q.emplace(
-                    wit.dist[next_vertex],
+                    d,
                     next_vertex
                 );
             }
         }
     }
+
+    template <typename T, typename I, typename Queue>
+    void relax_dijkstra_with_priority_queue(
+        Graph<T, I> &g,
+        Queue &Q,
+        ShortestPathTreeWitnessV2<T, I> &wit,
+        OperationCapper *capper = nullptr,
+        vector<size_t> *settled = nullptr
+    ) {
+        DenseTree<T, I> tree{wit};
+        relax_dijkstra_on_tree(g, Q, tree, capper, settled);
+    }
+}
+
+namespace internal {
+    // find_parent_cycle looks for a cycle in the parent-edge graph of wit.
+    // For every label-correcting algorithm (dijkstra, bellman-ford, lazy_dijkstra)
+    // a cycle of parent edges is a negative cycle, and one always shows up
+    // after finitely many relaxations if a negative cycle is reachable.
+    // Every vertex is visited at most once, so this is O(n).
+    // @return edge indices of the cycle in path order, or empty if there is none.
+    // Tree: DenseTree or WorkspaceTree.
+    template <typename T, typename I, typename Tree>
+    NegativeCycleWitness find_parent_cycle_on_tree(
+        Graph<T, I> &g,
+        const Tree &tree
+    ) {
+        size_t n = g.N();
+        // 0: unvisited, otherwise (index of the walk that visited it) + 1
+        vector<size_t> walk_id(n, 0);
+
+        for(size_t start = 0; start < n; start++) {
+            if(walk_id[start]) continue;
+
+            size_t v = start;
+            while(v != size_t(-1) && !walk_id[v]) {
+                walk_id[v] = start + 1;
+                I edge_idx = tree.parent(v);
+                v = edge_idx == I(-1) ? size_t(-1) : size_t(g.edges[edge_idx].s);
+            }
+
+            // reached a vertex of an earlier walk, or a root.
+            if(v == size_t(-1) || walk_id[v] != start + 1) continue;
+
+            // v is on a cycle. collect it backwards, then restore path order.
+            NegativeCycleWitness cycle;
+            size_t u = v;
+            do {
+                cycle.emplace_back(tree.parent(u));
+                u = g.edges[cycle.back()].s;
+            } while(u != v);
+
+            reverse(cycle.begin(), cycle.end());
+            return cycle;
+        }
+
+        return NegativeCycleWitness();
+    }
+
+    template <typename T, typename I>
+    NegativeCycleWitness find_parent_cycle(
+        Graph<T, I> &g,
+        ShortestPathTreeWitnessV2<T, I> &wit
+    ) {
+        return find_parent_cycle_on_tree(g, DenseTree<T, I>{wit});
+    }
 }
 
 namespace naive_dijkstra {
@@ -68,9 +178,9 @@ namespace naive_dijkstra {
     // @param ignore_negative_edges: if false, make error when negative edges are present.
     // otherwise, ignore negative edges and proceed dijkstra's algorithm only with non-negative edges.
     // @return The distance vector from src.
-    template <typename T, typename PairT = pair<T, size_t>>
-    ShortestPathTreeWitnessV2<T> multi_source(
-        Graph<T> &g,
+    template <typename T, typename I, typename PairT = pair<T, I>>
+    ShortestPathTreeWitnessV2<T, I> multi_source(
+        Graph<T, I> &g,
         vector<size_t> src, 
         bool ignore_negative_edges,
         OperationCapper *capper = nullptr
@@ -83,7 +193,7 @@ namespace naive_dijkstra {
             capper = new NoCapOperationCapper();
         }
 
-        ShortestPathTreeWitnessV2<T> wit(g.N());
+        ShortestPathTreeWitnessV2<T, I> wit(g.N());
         wit.dist = g.initial_dist();
 
         priority_queue<PairT, vector<PairT>, greater<PairT>> Q;
@@ -102,9 +212,9 @@ namespace naive_dijkstra {
     // @param ignore_negative_edges: if false, make error when negative edges are present.
     // otherwise, ignore negative edges and proceed dijkstra's algorithm only with non-negative edges.
     // @return The distance vector from src.
-    template <typename T>
-    ShortestPathTreeWitnessV2<T> single_source(
-        Graph<T> &g,
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> single_source(
+        Graph<T, I> &g,
         size_t src, 
         bool ignore_negative_edges,
         OperationCapper *capper = nullptr
@@ -112,16 +222,75 @@ namespace naive_dijkstra {
         return multi_source(g, vector<size_t>({src}), ignore_negative_edges, capper);
     }
 
-    // Naive dijkstra algorithm on non-negative edges.
-    template <typename T, typename PairT = pair<T, size_t>>
+    // Naive dijkstra with multiple sources, into a workspace.
+    // The tree is left in ws.dist / ws.parent_edge_idx, and the reached vertices in ws.touched,
+    // so the cost is proportional to the reached region rather than to n.
+    template <typename T, typename I>
+    void multi_source_sparse(
+        Graph<T, I> &g,
+        const vector<size_t> &src,
+        bool ignore_negative_edges,
+        Workspace<T, I> &ws,
+        OperationCapper *capper = nullptr
+    ) {
+        if(!ignore_negative_edges) {
+            assert(g.get_min_edge_weight() >= T(0));
+        }
+
+        if(capper == nullptr) {
+            capper = new NoCapOperationCapper();
+        }
+
+        ws.begin(g.N());
+        ReusableHeap<pair<T, I>> Q(ws.heap);
+        for(auto s : src) {
+            if(g.deleted_vertex(s)) continue;
+            ws.set(s, T(0), I(-1));
+            Q.emplace(T(0), s);
+        }
+
+        if(!capper -> incr()) return;
+
+        ReducedWeightView<T, I> weight(g);
+
+        while(!Q.empty()) {
+            auto [current_dist, current_vertex] = Q.top();
+            Q.pop();
+
+            if(current_dist != ws.dist.get(current_vertex)) continue;
+
+            for(auto edge_idx : g.adj[current_vertex]) {
+                if(g.deleted_edge(edge_idx)) continue;
+
+                T w = weight(edge_idx);
+                if(w < T(0)) continue;
+
+                size_t next_vertex = g.edges[edge_idx].e;
+                if(g.deleted_vertex(next_vertex)) continue;
+
+                T d = current_dist + w;
+                if(ws.dist.get(next_vertex) <= d) continue;
+
+                ws.set(next_vertex, d, edge_idx);
+                Q.emplace(d, next_vertex);
+            }
+        }
+    }
+
+    // Ball of radius r around src on non-negative edges, and the edges leaving it.
+    // Vertices beyond r are never stored nor pushed, and the distance map is the
+    // sparsely reset one of the workspace, so the cost is proportional to the ball
+    // and its out-edges rather than to n.
+    template <typename T, typename I>
     pair<
     vector<size_t>,
     vector<size_t>
     > get_ball_and_boundary(
-        Graph<T> &g,
+        Graph<T, I> &g,
         size_t src,
         T r,
-        OperationCapper *capper = nullptr
+        OperationCapper *capper = nullptr,
+        Workspace<T, I> *ws = nullptr
     ) {
         if(capper == nullptr) {
             capper = new NoCapOperationCapper();
@@ -133,71 +302,480 @@ namespace naive_dijkstra {
         // capper failure
         if(!capper->incr()) return pair(ball_vertices, boundary_edge_candidates);
 
-        auto dist = g.initial_dist();
+        Workspace<T, I> local_ws;
+        if(ws == nullptr) ws = &local_ws;
+        ws->begin(g.N());
 
-
-        priority_queue<PairT, vector<PairT>, greater<PairT>> Q;
-        Q.emplace(
-            dist[src] = 0,
-            src
-        );
+        ReducedWeightView<T, I> weight(g);
+        ReusableHeap<pair<T, I>> Q(ws->heap);
+        ws->set(src, T(0), I(-1));
+        Q.emplace(T(0), src);
 
         while(!Q.empty()) {
             auto [current_dist, current_vertex] = Q.top();
             Q.pop();
 
-            if(current_dist != dist[current_vertex]) continue;
-            if(current_dist > r) continue;
+            if(current_dist != ws->dist.get(current_vertex)) continue;
             ball_vertices.emplace_back(current_vertex);
             
             for(auto edge_idx : g.adj[current_vertex]) {
                 if(g.deleted_edge(edge_idx)) continue;
 
                 // skipped since edge is deleted
-                auto edge = g.edges[edge_idx];
+                T w = weight(edge_idx);
                 
                 // ignore negative edges
-                if(g.get_weight(edge) < T(0)) continue;
+                if(w < T(0)) continue;
                 
-                size_t next_vertex = edge.e;
+                size_t next_vertex = g.edges[edge_idx].e;
 
                 // skipped since next vertex is deleted
                 if(g.deleted_vertex(next_vertex)) continue;
-                
-                if(dist[next_vertex] > dist[current_vertex] + g.get_weight(edge)) {
-                    // relax
-                    Q.emplace(
-                        dist[next_vertex] = dist[current_vertex] + g.get_weight(edge),
-                        next_vertex
-                    );
-                }
 
-                // add boundary candidates
-                if(dist[next_vertex] > r) {
+                // beyond the radius: a boundary edge, unless its end joins the ball later
+                T d = current_dist + w;
+                if(d > r) {
                     boundary_edge_candidates.emplace_back(edge_idx);
+                    continue;
+                }
+
+                if(ws->dist.get(next_vertex) > d) {
+                    // relax
+                    ws->set(next_vertex, d, edge_idx);
+                    Q.emplace(d, next_vertex);
                 }
             }
         }
 
+        // every vertex with a distance is in the ball.
         vector<size_t> boundary_edges;
         for(auto edge_idx : boundary_edge_candidates) {
-            auto edge = g.edges[edge_idx];
-            if(dist[edge.s] <= r || dist[edge.e] > r) boundary_edges.emplace_back(edge_idx);
+            if(!ws->dist.has(g.edges[edge_idx].e)) boundary_edges.emplace_back(edge_idx);
         }
 
         return pair(ball_vertices, boundary_edges);
     }
+    // Naive dijkstra from src into a workspace, stopping as soon as every target is
+    // settled. A target with a distance in ws has its exact distance and tree path
+    // there, and a target without one is unreachable. Other vertices in ws may only
+    // hold upper bounds.
+    template <typename T, typename I>
+    void multi_target(
+        Graph<T, I> &g,
+        size_t src,
+        vector<size_t> targets,
+        Workspace<T, I> &ws,
+        OperationCapper *capper = nullptr
+    ) {
+        if(capper == nullptr) {
+            capper = new NoCapOperationCapper();
+        }
+
+        sort(targets.begin(), targets.end());
+        targets.erase(unique(targets.begin(), targets.end()), targets.end());
+        size_t remaining = targets.size();
+
+        ws.begin(g.N());
+        if(!capper -> incr()) return;
+
+        ReusableHeap<pair<T, I>> Q(ws.heap);
+        ws.set(src, T(0), I(-1));
+        Q.emplace(T(0), src);
+
+        ReducedWeightView<T, I> weight(g);
+
+        while(!Q.empty() && remaining > 0) {
+            auto [current_dist, current_vertex] = Q.top();
+            Q.pop();
+
+            if(current_dist != ws.dist.get(current_vertex)) continue;
+            if(binary_search(targets.begin(), targets.end(), size_t(current_vertex))) --remaining;
+
+            for(auto edge_idx : g.adj[current_vertex]) {
+                if(g.deleted_edge(edge_idx)) continue;
+
+                T w = weight(edge_idx);
+                if(w < T(0)) continue;
+
+                size_t next_vertex = g.edges[edge_idx].e;
+                if(g.deleted_vertex(next_vertex)) continue;
+
+                T d = current_dist + w;
+                if(ws.dist.get(next_vertex) <= d) continue;
+
+                ws.set(next_vertex, d, edge_idx);
+                Q.emplace(d, next_vertex);
+            }
+        }
+    }
 } // naive_dijkstra
 
+namespace bidirectional_dijkstra {
+    // Bidirectional dijkstra from src to dst, on non-negative reduced weights.
+    // One search runs forward from src over adj and one backward from dst over radj,
+    // and each step advances the side with the smaller heap top. mu is the best
+    // src -> dst length through an edge seen by both sides; once the two tops add up
+    // to mu, no shorter path is left.
+    // forward / backward: optional workspaces for the two searches.
+    // @return the reduced distance and the edge indices of a shortest path,
+    // or numeric_limits<T>::max() and no edges if dst is unreachable.
+    template <typename T, typename I>
+    pair<T, vector<I>> single_target(
+        Graph<T, I> &g,
+        size_t src,
+        size_t dst,
+        OperationCapper *capper = nullptr,
+        Workspace<T, I> *forward = nullptr,
+        Workspace<T, I> *backward = nullptr
+    ) {
+        if(capper == nullptr) {
+            capper = new NoCapOperationCapper();
+        }
+
+        const T INF = numeric_limits<T>::max();
+        if(!capper -> incr()) return pair(INF, vector<I>());
+        if(src == dst) return pair(T(0), vector<I>());
+
+        Workspace<T, I> local_forward, local_backward;
+        if(forward == nullptr) forward = &local_forward;
+        if(backward == nullptr) backward = &local_backward;
+        forward->begin(g.N());
+        backward->begin(g.N());
+
+        ReusableHeap<pair<T, I>> forward_queue(forward->heap), backward_queue(backward->heap);
+        forward->set(src, T(0), I(-1));
+        forward_queue.emplace(T(0), src);
+        backward->set(dst, T(0), I(-1));
+        backward_queue.emplace(T(0), dst);
+
+        ReducedWeightView<T, I> weight(g);
+
+        T mu = INF;
+        I meet_edge = I(-1); // its start is on the forward side, its end on the backward side
+
+        while(!forward_queue.empty() && !backward_queue.empty()) {
+            // tops may be stale, but they are still lower bounds of what is left.
+            if(forward_queue.top().first + backward_queue.top().first >= mu) break;
+
+            bool is_forward = forward_queue.top().first <= backward_queue.top().first;
+            auto &Q = is_forward ? forward_queue : backward_queue;
+            auto &ws = is_forward ? *forward : *backward;
+            auto &other = is_forward ? *backward : *forward;
+
+            auto [current_dist, current_vertex] = Q.top();
+            Q.pop();
+
+            if(current_dist != ws.dist.get(current_vertex)) continue;
+
+            for(auto edge_idx : is_forward ? g.adj[current_vertex] : g.radj[current_vertex]) {
+                if(g.deleted_edge(edge_idx)) continue;
+
+                T w = weight(edge_idx);
+                if(w < T(0)) continue;
+
+                const auto &e = g.edges[edge_idx];
+                size_t next_vertex = is_forward ? e.e : e.s;
+                if(g.deleted_vertex(next_vertex)) continue;
+
+                T d = current_dist + w;
+                if(d < ws.dist.get(next_vertex)) {
+                    ws.set(next_vertex, d, edge_idx);
+                    Q.emplace(d, next_vertex);
+                }
+
+                if(other.dist.has(next_vertex) && d + other.dist.get(next_vertex) < mu) {
+                    mu = d + other.dist.get(next_vertex);
+                    meet_edge = edge_idx;
+                }
+            }
+        }
+
+        if(meet_edge == I(-1)) return pair(INF, vector<I>());
+
+        // forward tree path to the start of meet_edge, then the backward tree path from its end.
+        vector<I> path;
+        for(size_t v = g.edges[meet_edge].s; forward->parent_edge_idx.get(v) != I(-1); ) {
+            I edge_idx = forward->parent_edge_idx.get(v);
+            path.emplace_back(edge_idx);
+            v = g.edges[edge_idx].s;
+        }
+        reverse(path.begin(), path.end());
+        path.emplace_back(meet_edge);
+        for(size_t v = g.edges[meet_edge].e; backward->parent_edge_idx.get(v) != I(-1); ) {
+            I edge_idx = backward->parent_edge_idx.get(v);
+            path.emplace_back(edge_idx);
+            v = g.edges[edge_idx].e;
+        }
+
+        return pair(mu, path);
+    }
+} // bidirectional_dijkstra
+
+namespace bit_parallel {
+    // Balls of radius r around up to 64 sources at once, on non-negative edges.
+    // On return, bit i of mask[v] is set iff dist(src[i], v) <= r.
+    // Layers are processed by increasing distance, and each (vertex, bits) entry only
+    // carries the bits reaching the vertex for the first time, so a vertex is expanded
+    // at most once per distinct distance at which new sources reach it.
+    // mask: n-sized and all zero on entry. touched: receives the vertices with a non-zero mask.
+    template <typename T, typename I>
+    void ball_masks(
+        Graph<T, I> &g,
+        const vector<size_t> &src,
+        T r,
+        vector<uint64_t> &mask,
+        vector<size_t> &touched
+    ) {
+        assert(src.size() <= 64);
+        touched.clear();
+
+        // distance -> (vertex, bits) arriving at that distance.
+        map<T, vector<pair<I, uint64_t>>> layers;
+        for(size_t i = 0; i < src.size(); i++) {
+            if(g.deleted_vertex(src[i])) continue;
+            layers[T(0)].emplace_back(src[i], uint64_t(1) << i);
+        }
+
+        ReducedWeightView<T, I> weight(g);
+
+        while(!layers.empty()) {
+            auto it = layers.begin();
+            T d = it -> first;
+            auto &layer = it -> second;
+
+            // zero weight edges append to this layer while it is scanned.
+            for(size_t j = 0; j < layer.size(); j++) {
+                auto [v, bits] = layer[j];
+                bits &= ~mask[v];
+                if(bits == 0) continue;
+                if(mask[v] == 0) touched.emplace_back(v);
+                mask[v] |= bits;
+
+                for(auto edge_idx : g.adj[v]) {
+                    if(g.deleted_edge(edge_idx)) continue;
+
+                    T w = weight(edge_idx);
+                    if(w < T(0) || w > r - d) continue;
+
+                    size_t x = g.edges[edge_idx].e;
+                    if(g.deleted_vertex(x) || (bits & ~mask[x]) == 0) continue;
+
+                    layers[d + w].emplace_back(x, bits);
+                }
+            }
+
+            layers.erase(it);
+        }
+    }
+} // bit_parallel
+
+
+namespace delta_stepping {
+    // frontiers with fewer out-edges than this are relaxed on the calling thread:
+    // below it, starting and joining the threads costs more than the relaxations.
+    constexpr size_t PARALLEL_RELAX_MIN_EDGES = 4096;
+
+    // default_delta picks the mean non-negative (reduced) edge weight, at least 1.
+    template <typename T, typename I>
+    T default_delta(Graph<T, I> &g) {
+        long double sum = 0;
+        size_t cnt = 0;
+        ReducedWeightView<T, I> weight(g);
+        for(size_t edge_idx = 0, m = g.M(); edge_idx < m; edge_idx++) {
+            T w = weight(edge_idx);
+            if(w < T(0)) continue;
+            sum += w;
+            ++cnt;
+        }
+        if(cnt == 0) return T(1);
+        return max(T(1), T(sum / cnt));
+    }
+
+    // Delta-stepping (Meyer & Sanders) with multiple sources, on non-negative reduced weights.
+    // Vertices are kept in buckets of width delta. Each phase relaxes the edges out of
+    // the current bucket: light edges (w <= delta) repeatedly until the bucket is empty,
+    // then heavy edges once. On large frontiers, relaxation requests are generated in
+    // parallel and applied in parallel by the thread owning the target vertex
+    // (v % num_threads); small ones are relaxed serially (PARALLEL_RELAX_MIN_EDGES).
+    // @param ignore_negative_edges: same as naive_dijkstra::multi_source.
+    // @param delta: bucket width. T(0) picks default_delta(g).
+    // @param src_dist: start distance of each source, all zero if empty.
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> multi_source(
+        Graph<T, I> &g,
+        vector<size_t> src,
+        bool ignore_negative_edges,
+        OperationCapper *capper = nullptr,
+        size_t num_threads = 1,
+        T delta = T(0),
+        const vector<T> &src_dist = vector<T>()
+    ) {
+        if(!ignore_negative_edges) {
+            assert(g.get_min_edge_weight() >= T(0));
+        }
+
+        if(capper == nullptr) {
+            capper = new NoCapOperationCapper();
+        }
+
+        if(delta <= T(0)) delta = default_delta(g);
+        num_threads = max<size_t>(1, num_threads);
+
+        const T INF = numeric_limits<T>::max();
+        size_t n = g.N();
+
+        ShortestPathTreeWitnessV2<T, I> wit(n);
+        wit.dist = g.initial_dist();
+
+        // bucket index -> vertices, possibly stale or duplicated.
+        map<T, vector<size_t>> buckets;
+        auto bucket_of = [&](T d) { return d / delta; };
+
+        for(size_t i = 0; i < src.size(); i++) {
+            size_t s = src[i];
+            T d = src_dist.empty() ? T(0) : src_dist[i];
+            if(g.deleted_vertex(s) || wit.dist[s] <= d) continue;
+            wit.dist[s] = d;
+            buckets[bucket_of(d)].emplace_back(s);
+        }
+
+        struct Request {
+            I v;
+            T d;
+            I edge_idx;
+        };
+        // requests[generating thread][owner thread]
+        vector<vector<vector<Request>>> requests(num_threads, vector<vector<Request>>(num_threads));
+        vector<vector<size_t>> improved(num_threads);
+        // processed[v] == current bucket index + 1 if v was scanned in this bucket.
+        vector<T> processed(n, T(-1));
+
+        ReducedWeightView<T, I> weight(g);
+
+        // relax light or heavy edges out of frontier, and return improved vertices.
+        auto relax = [&](const vector<size_t> &frontier, bool light) {
+            size_t work = 0;
+            for(auto u : frontier) work += g.adj[u].size();
+
+            if(num_threads == 1 || work < PARALLEL_RELAX_MIN_EDGES) {
+                vector<size_t> ret;
+                for(auto u : frontier) {
+                    for(auto edge_idx : g.adj[u]) {
+                        if(g.deleted_edge(edge_idx)) continue;
+                        const auto &edge = g.edges[edge_idx];
+                        T w = weight(edge_idx);
+                        if(w < T(0) || (w <= delta) != light) continue;
+                        if(g.deleted_vertex(edge.e)) continue;
+                        T d = wit.dist[u] + w;
+                        if(d >= wit.dist[edge.e]) continue;
+                        wit.dist[edge.e] = d;
+                        wit.parent_edge_idx[edge.e] = edge_idx;
+                        ret.emplace_back(edge.e);
+                    }
+                }
+                return ret;
+            }
+
+            parallel_for(0, frontier.size(), num_threads, [&](size_t lo, size_t hi, size_t t) {
+                for(size_t i = lo; i < hi; i++) {
+                    size_t u = frontier[i];
+                    for(auto edge_idx : g.adj[u]) {
+                        if(g.deleted_edge(edge_idx)) continue;
+                        const auto &edge = g.edges[edge_idx];
+                        T w = weight(edge_idx);
+                        if(w < T(0) || (w <= delta) != light) continue;
+                        if(g.deleted_vertex(edge.e)) continue;
+                        T d = wit.dist[u] + w;
+                        if(d < wit.dist[edge.e]) requests[t][edge.e % num_threads].push_back({edge.e, d, edge_idx});
+                    }
+                }
+            }, 64);
+
+            parallel_for(0, num_threads, num_threads, [&](size_t lo, size_t hi, size_t) {
+                for(size_t owner = lo; owner < hi; owner++) {
+                    improved[owner].clear();
+                    for(size_t t = 0; t < num_threads; t++) {
+                        for(auto &r : requests[t][owner]) {
+                            if(r.d >= wit.dist[r.v]) continue;
+                            wit.dist[r.v] = r.d;
+                            wit.parent_edge_idx[r.v] = r.edge_idx;
+                            improved[owner].emplace_back(r.v);
+                        }
+                        requests[t][owner].clear();
+                    }
+                }
+            }, 1);
+
+            vector<size_t> ret;
+            for(auto &imp : improved) {
+                for(auto v : imp) ret.emplace_back(v);
+            }
+            return ret;
+        };
+
+        while(!buckets.empty()) {
+            if(!capper -> incr()) return wit;
+
+            T b = buckets.begin() -> first;
+            vector<size_t> settled;
+
+            while(buckets.count(b)) {
+                vector<size_t> frontier;
+                for(auto v : buckets[b]) {
+                    // skip stale entries and vertices already scanned in this round of b
+                    if(wit.dist[v] == INF || bucket_of(wit.dist[v]) != b || processed[v] == b + 1) continue;
+                    processed[v] = b + 1;
+                    frontier.emplace_back(v);
+                }
+                buckets.erase(b);
+
+                for(auto v : relax(frontier, true)) {
+                    // re-scan v if it improved again within the same bucket
+                    if(bucket_of(wit.dist[v]) == b) processed[v] = T(-1);
+                    buckets[bucket_of(wit.dist[v])].emplace_back(v);
+                }
+
+                for(auto v : frontier) settled.emplace_back(v);
+            }
+
+            sort(settled.begin(), settled.end());
+            settled.erase(unique(settled.begin(), settled.end()), settled.end());
+
+            for(auto v : relax(settled, false)) {
+                buckets[bucket_of(wit.dist[v])].emplace_back(v);
+            }
+        }
+
+        return wit;
+    }
+
+    // Delta-stepping with single source. See multi_source.
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> single_source(
+        Graph<T, I> &g,
+        size_t src,
+        bool ignore_negative_edges,
+        OperationCapper *capper = nullptr,
+        size_t num_threads = 1,
+        T delta = T(0)
+    ) {
+        return multi_source(g, vector<size_t>({src}), ignore_negative_edges, capper, num_threads, delta);
+    }
+} // delta_stepping
 
 namespace bellman_ford {
+    // times spfa and parallel_multi_source look for a negative cycle in the parent
+    // edges, n edges of walk (or n passes) apart, before giving up with UNKNOWN.
+    constexpr size_t NEGATIVE_CYCLE_SEARCHES = 3;
+
     // Bellman-ford algorithm with multiple sources.
-    template <typename T>
-    ShortestPathTreeWitnessV2<T> multi_source(
-        Graph<T> &g,
+    // Stops as soon as a pass relaxes nothing, after at most n - 1 passes.
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> multi_source(
+        Graph<T, I> &g,
         vector<size_t> src
     ) {
-        ShortestPathTreeWitnessV2<T> wit(g.N());
+        ShortestPathTreeWitnessV2<T, I> wit(g.N());
         wit.dist = g.initial_dist();
 
         for(auto s : src) {
@@ -205,26 +783,31 @@ namespace bellman_ford {
         }
 
         auto n = g.N();
-        for(int i = 0; i < n - 1; i++) {
+        ReducedWeightView<T, I> weight(g);
+        for(size_t i = 0; i + 1 < n; i++) {
+            bool changed = false;
             size_t edge_idx = 0;
-            for(auto e : g.edges) {
+            for(const auto &e : g.edges) {
                 if(wit.dist[e.s] != numeric_limits<T>::max()) { 
                     // negative edge & e.s is reached out
-                    if(wit.dist[e.e] > wit.dist[e.s] + g.get_weight(e)) {
-                        wit.dist[e.e] = wit.dist[e.s] + g.get_weight(e);
+                    T w = weight(edge_idx);
+                    if(wit.dist[e.e] > wit.dist[e.s] + w) {
+                        wit.dist[e.e] = wit.dist[e.s] + w;
                         wit.parent_edge_idx[e.e] = edge_idx;
+                        changed = true;
                     }
                 }
                 ++edge_idx;
             }
+            if(!changed) break;
         }
         return wit;
     }
 
     // bellman-ford algorithm with a single source.
-    template <typename T>
-    ShortestPathTreeWitnessV2<T> single_source(
-        Graph<T> g,
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> single_source(
+        Graph<T, I> &g,
         size_t src
     ) {
         return multi_source(g, vector<size_t>({src}));
@@ -232,56 +815,304 @@ namespace bellman_ford {
 
     // bellman-ford algorithm with all vertices as source.
     // distance map will be non-positive in this case.
-    template <typename T>
-    ShortestPathTreeWitnessV2<T> all_source(
-        Graph<T> g
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> all_source(
+        Graph<T, I> &g
     ) {
         vector<size_t> src(g.N());
         iota(src.begin(), src.end(), 0);
         return multi_source(g, src);
     }
-} // bellman_ford
 
-namespace lazy_dijkstra {
-    template <typename T, typename PairT = pair<T, size_t>>
-    ShortestPathTreeWitnessV2<T> predetermined_initial_wit(
-        Graph<T> &g,
-        ShortestPathTreeWitnessV2<T> wit,
-        size_t kappa,
-        bool validate,
+    // SPFA: queue-based bellman-ford that only rescans vertices whose distance changed.
+    // A vertex whose shortest walk found so far has n or more edges proves a negative cycle,
+    // which is then extracted from the parent edges. It nearly always shows up there at
+    // once; the parent edges are searched again every n edges of walk, up to
+    // NEGATIVE_CYCLE_SEARCHES times.
+    // @return the tree, a negative cycle, or UNKNOWN if the capper (one operation per
+    // scanned vertex) ran out or the searches did not find the cycle.
+    template <typename T, typename I>
+    Witness<T, I> spfa(
+        Graph<T, I> &g,
+        vector<size_t> src,
         OperationCapper *capper = nullptr
     ) {
         if(capper == nullptr) {
             capper = new NoCapOperationCapper();
         }
-        priority_queue<PairT, vector<PairT>, greater<PairT>> Q;
 
-        for(size_t i = 0; i < g.N(); i++) {
-            Q.emplace(wit.dist[i], i);
+        const T INF = numeric_limits<T>::max();
+        size_t n = g.N();
+
+        Witness<T, I> ret;
+        ret.state = UNKNOWN;
+        auto &wit = ret.shortest_path_tree_witness;
+        wit = ShortestPathTreeWitnessV2<T, I>(n);
+        wit.dist = g.initial_dist();
+
+        ReducedWeightView<T, I> weight(g);
+        vector<size_t> len(n, 0); // number of edges on the walk to v
+        vector<bool> in_queue(n, false);
+        queue<size_t> q;
+
+        for(auto s : src) {
+            wit.dist[s] = T(0);
+            if(!in_queue[s]) q.emplace(s), in_queue[s] = true;
         }
 
+        while(!q.empty()) {
+            if(!capper -> incr()) return ret;
+
+            size_t u = q.front(); q.pop();
+            in_queue[u] = false;
+
+            for(auto edge_idx : g.adj[u]) {
+                const auto &e = g.edges[edge_idx];
+                if(wit.dist[u] == INF) continue;
+                T d = wit.dist[u] + weight(edge_idx);
+                if(d >= wit.dist[e.e]) continue;
+
+                wit.dist[e.e] = d;
+                wit.parent_edge_idx[e.e] = edge_idx;
+                len[e.e] = len[u] + 1;
+
+                if(len[e.e] % n == 0) {
+                    auto cycle = internal::find_parent_cycle(g, wit);
+                    if(!cycle.empty()) return make_witness_for_negative_cycle<T, I>(cycle);
+                    if(len[e.e] / n >= NEGATIVE_CYCLE_SEARCHES) return ret;
+                }
+
+                if(!in_queue[e.e]) q.emplace(e.e), in_queue[e.e] = true;
+            }
+        }
+
+        ret.state = SHORTEST_PATH_TREE_FOUND;
+        return ret;
+    }
+
+    // Edge-parallel bellman-ford. Edges are laid out by target in flat arrays
+    // (source, reduced weight, edge index), and every pass pulls
+    //     next[v] = min(cur[v], min over in-edges (cur[s] + w))
+    // for a chunk of targets per thread. The min-reduction runs over contiguous
+    // arrays and vectorizes; passes stop early once nothing changes.
+    // If the n-th pass still changes something there is a negative cycle, which is
+    // extracted from the parent edges, searched every n passes up to
+    // NEGATIVE_CYCLE_SEARCHES times.
+    // @return the tree, a negative cycle, or UNKNOWN if the capper (one operation per
+    // pass) ran out or the searches did not find the cycle.
+    template <typename T, typename I>
+    Witness<T, I> parallel_multi_source(
+        Graph<T, I> &g,
+        vector<size_t> src,
+        size_t num_threads,
+        OperationCapper *capper = nullptr
+    ) {
+        if(capper == nullptr) {
+            capper = new NoCapOperationCapper();
+        }
+
+        const T INF = numeric_limits<T>::max();
+        size_t n = g.N(), m = g.M();
+        num_threads = max<size_t>(1, num_threads);
+
+        // in-edges by target, structure of arrays.
+        vector<size_t> in_begin(n + 1, 0);
+        vector<I> in_src(m), in_edge(m);
+        vector<T> in_w(m);
+        for(auto &e : g.edges) ++in_begin[e.e + 1];
+        for(size_t v = 0; v < n; v++) in_begin[v + 1] += in_begin[v];
+        {
+            ReducedWeightView<T, I> weight(g);
+            vector<size_t> fill(in_begin.begin(), in_begin.end() - 1);
+            for(size_t edge_idx = 0; edge_idx < m; edge_idx++) {
+                const auto &e = g.edges[edge_idx];
+                size_t k = fill[e.e]++;
+                in_src[k] = e.s;
+                in_w[k] = weight(edge_idx);
+                in_edge[k] = edge_idx;
+            }
+        }
+
+        Witness<T, I> ret;
+        ret.state = UNKNOWN;
+        auto &wit = ret.shortest_path_tree_witness;
+        wit = ShortestPathTreeWitnessV2<T, I>(n);
+        wit.dist = g.initial_dist();
+        for(auto s : src) {
+            wit.dist[s] = T(0);
+        }
+
+        vector<T> next = wit.dist;
+        vector<char> changed(num_threads);
+
+        for(size_t pass = 0; ; pass++) {
+            if(!capper -> incr()) return ret;
+            fill(changed.begin(), changed.end(), 0);
+
+            parallel_for(0, n, num_threads, [&](size_t lo, size_t hi, size_t t) {
+                const T *cur = wit.dist.data();
+                const I *srcs = in_src.data();
+                const T *ws = in_w.data();
+
+                for(size_t v = lo; v < hi; v++) {
+                    T best = cur[v];
+                    for(size_t k = in_begin[v]; k < in_begin[v + 1]; k++) {
+                        T ds = cur[srcs[k]];
+                        T cand = ds == INF ? INF : ds + ws[k];
+                        best = cand < best ? cand : best;
+                    }
+                    next[v] = best;
+                    if(best == cur[v]) continue;
+
+                    // improved: find the edge achieving it.
+                    for(size_t k = in_begin[v]; k < in_begin[v + 1]; k++) {
+                        if(cur[srcs[k]] != INF && cur[srcs[k]] + ws[k] == best) {
+                            wit.parent_edge_idx[v] = in_edge[k];
+                            break;
+                        }
+                    }
+                    changed[t] = 1;
+                }
+            });
+
+            wit.dist.swap(next);
+            if(count(changed.begin(), changed.end(), 1) == 0) break;
+
+            // n passes cover every simple path: still changing means a negative cycle.
+            if((pass + 1) % n == 0) {
+                auto cycle = internal::find_parent_cycle(g, wit);
+                if(!cycle.empty()) return make_witness_for_negative_cycle<T, I>(cycle);
+                if((pass + 1) / n >= NEGATIVE_CYCLE_SEARCHES) return ret;
+            }
+        }
+
+        ret.state = SHORTEST_PATH_TREE_FOUND;
+        return ret;
+    }
+} // bellman_ford
+
+namespace lazy_dijkstra {
+    // the rounds of lazy dijkstra on tree, with Q seeded. See predetermined_initial_wit.
+    template <typename T, typename I, typename Queue, typename Tree>
+    void run_rounds(
+        Graph<T, I> &g,
+        Queue &Q,
+        Tree &tree,
+        size_t kappa,
+        OperationCapper *capper,
+        NegativeCycleWitness *negative_cycle,
+        bool sparse_seeding,
+        vector<size_t> &settled
+    ) {
+        const T INF = numeric_limits<T>::max();
+        ReducedWeightView<T, I> weight(g);
+
+        // relaxes edge_idx if it is negative, and queues its end if it improved.
+        auto relax_negative = [&](size_t edge_idx) {
+            const auto &e = g.edges[edge_idx];
+            T w = weight(edge_idx);
+            // negative edge & e.s is reached out
+            if(w >= T(0)) return;
+            T ds = tree.dist(e.s);
+            if(ds != INF && tree.dist(e.e) > ds + w) {
+                tree.set(e.e, ds + w, edge_idx);
+                Q.emplace(
+                    ds + w,
+                    e.e
+                );
+            }
+        };
+
         for(size_t counter = 0; counter < kappa && !Q.empty(); counter++) {
             // dijkstra stage.
-            internal::relax_dijkstra_with_priority_queue(g, Q, wit, capper);
-            if(capper->fail()) return wit;
+            settled.clear();
+            internal::relax_dijkstra_on_tree(g, Q, tree, capper, sparse_seeding ? &settled : nullptr);
+            if(capper->fail()) return;
 
             // bellman-ford with negative edges.
-            auto edge_idx = 0;
-            for(auto e : g.edges) {
-                if(g.get_weight(e) < T(0) && wit.dist[e.s] != numeric_limits<T>::max()) { 
-                    // negative edge & e.s is reached out
-                    if(wit.dist[e.e] > wit.dist[e.s] + g.get_weight(e)) {
-                        wit.dist[e.e] = wit.dist[e.s] + g.get_weight(e);
-                        wit.parent_edge_idx[e.e] = edge_idx;
-                        Q.emplace(
-                            wit.dist[e.e],
-                            e.e
-                        );
-                    }
+            if(sparse_seeding) {
+                // a negative edge can only be violated if its start changed this round.
+                for(auto v : settled) {
+                    for(auto edge_idx : g.adj[v]) relax_negative(edge_idx);
                 }
-                ++edge_idx;
+            } else {
+                for(size_t edge_idx = 0, m = g.M(); edge_idx < m; edge_idx++) relax_negative(edge_idx);
+            }
+
+            bool last_round = counter + 1 == kappa && !Q.empty();
+            bool power_of_two = ((counter + 1) & counter) == 0;
+            if(negative_cycle != nullptr && !Q.empty() && (last_round || power_of_two)) {
+                *negative_cycle = internal::find_parent_cycle_on_tree(g, tree);
+                if(!negative_cycle->empty()) return;
             }
         }
+    }
+
+    // lazy dijkstra from a given initial distance map.
+    // @param negative_cycle: if given, the parent-edge graph is searched for a cycle
+    // after rounds 1, 2, 4, 8, ... and when kappa rounds did not converge.
+    // A cycle found is stored there and the search stops early, so a negative cycle
+    // costs O(work until it appears) instead of the whole kappa / capper budget.
+    // @param ws: if given, the rounds write to its sparse tree and heap instead of wit,
+    // and only the vertices they changed are copied back into wit at the end.
+    // @param sparse_seeding: seed the heap only with the ends of edges that wit violates,
+    // heapified in O(k), and scan in each round only the negative edges out of vertices
+    // changed in that round. Every round then costs O(changed region) instead of O(n + m),
+    // which pays off when wit is almost a solution (e.g. the final step of rsssp).
+    template <typename T, typename I, typename PairT = pair<T, I>>
+    ShortestPathTreeWitnessV2<T, I> predetermined_initial_wit(
+        Graph<T, I> &g,
+        ShortestPathTreeWitnessV2<T, I> wit,
+        size_t kappa,
+        bool validate,
+        OperationCapper *capper = nullptr,
+        NegativeCycleWitness *negative_cycle = nullptr,
+        Workspace<T, I> *ws = nullptr,
+        bool sparse_seeding = false
+    ) {
+        if(capper == nullptr) {
+            capper = new NoCapOperationCapper();
+        }
+        vector<PairT> local_heap;
+        ReusableHeap<PairT> Q(ws != nullptr ? ws->heap : local_heap);
+
+        const T INF = numeric_limits<T>::max();
+        size_t n = g.N();
+
+        // seeds the heap in O(k) and runs the rounds on tree.
+        auto run = [&](auto &tree, vector<size_t> &settled) {
+            if(sparse_seeding) {
+                // only the end of a violated edge can improve: relax every violated edge once.
+                ReducedWeightView<T, I> weight(g);
+                for(size_t edge_idx = 0, m = g.M(); edge_idx < m; edge_idx++) {
+                    const auto &e = g.edges[edge_idx];
+                    T ds = tree.dist(e.s);
+                    if(ds == INF) continue;
+                    T d = ds + weight(edge_idx);
+                    if(d >= tree.dist(e.e)) continue;
+                    tree.set(e.e, d, edge_idx);
+                    Q.c.emplace_back(d, e.e);
+                }
+            } else {
+                for(size_t i = 0; i < n; i++) {
+                    if(wit.dist[i] != INF) Q.c.emplace_back(wit.dist[i], i);
+                }
+            }
+            Q.heapify();
+            run_rounds(g, Q, tree, kappa, capper, negative_cycle, sparse_seeding, settled);
+        };
+
+        if(ws != nullptr) {
+            ws->begin(n);
+            internal::WorkspaceTree<T, I> tree{*ws, wit};
+            run(tree, ws->settled);
+            tree.store(wit);
+        } else {
+            vector<size_t> settled;
+            internal::DenseTree<T, I> tree{wit};
+            run(tree, settled);
+        }
+        if(capper->fail() || (negative_cycle != nullptr && !negative_cycle->empty())) return wit;
 
         if( validate ) {
             assert( validate_shortest_path_tree(g, wit) );
@@ -293,65 +1124,77 @@ namespace lazy_dijkstra {
     // lazy dijkstra with multiple sources. This is from BCF23.
     // Complexity: O(dijkstra * kappa)
     // kappa: guaranteed upper bound of loop iterations.
-    template <typename T, typename PairT = pair<T, size_t>>
-    ShortestPathTreeWitnessV2<T> multi_source(
-        Graph<T> &g,
+    template <typename T, typename I, typename PairT = pair<T, I>>
+    ShortestPathTreeWitnessV2<T, I> multi_source(
+        Graph<T, I> &g,
         vector<size_t> src,
         size_t kappa,
         bool validate,
-        OperationCapper *capper = nullptr
+        OperationCapper *capper = nullptr,
+        NegativeCycleWitness *negative_cycle = nullptr,
+        Workspace<T, I> *ws = nullptr
     ) {
-        priority_queue<PairT, vector<PairT>, greater<PairT>> Q;
-
-        ShortestPathTreeWitnessV2<T> wit(g.N());
+        ShortestPathTreeWitnessV2<T, I> wit(0);
         wit.dist = g.initial_dist();
+        wit.parent_edge_idx.assign(g.N(), I(-1));
 
         for(auto s : src) {
             wit.dist[s] = T(0);
         }
 
-        return predetermined_initial_wit(g, wit, kappa, validate, capper);
+        return predetermined_initial_wit(g, move(wit), kappa, validate, capper, negative_cycle, ws);
     }
 
     // lazy dijkstra with single source. This is from BCF23.
     // Complexity: O(dijkstra * kappa)
     // kappa: guaranteed upper bound of loop iterations.
-    template <typename T, typename PairT = pair<T, size_t>>
-    ShortestPathTreeWitnessV2<T> single_source(
-        Graph<T> &g,
+    template <typename T, typename I, typename PairT = pair<T, I>>
+    ShortestPathTreeWitnessV2<T, I> single_source(
+        Graph<T, I> &g,
         size_t src,
         size_t kappa,
         bool validate,
-        OperationCapper *capper = nullptr
+        OperationCapper *capper = nullptr,
+        NegativeCycleWitness *negative_cycle = nullptr,
+        Workspace<T, I> *ws = nullptr
     ) {
-        return multi_source(g, vector<size_t>({src}), kappa, validate, capper);
+        return multi_source(g, vector<size_t>({src}), kappa, validate, capper, negative_cycle, ws);
     }
 
     // lazy dijkstra with all vertices as source. This is from BCF23.
     // Complexity: O(dijkstra * kappa)
     // kappa: guaranteed upper bound of loop iterations.
-    template <typename T, typename PairT = pair<T, size_t>>
-    ShortestPathTreeWitnessV2<T> all_source(
-        Graph<T> &g,
+    template <typename T, typename I, typename PairT = pair<T, I>>
+    ShortestPathTreeWitnessV2<T, I> all_source(
+        Graph<T, I> &g,
         size_t kappa,
         bool validate,
-        OperationCapper *capper = nullptr
+        OperationCapper *capper = nullptr,
+        NegativeCycleWitness *negative_cycle = nullptr,
+        Workspace<T, I> *ws = nullptr
     ) {
         vector<size_t> src(g.N());
         iota(src.begin(), src.end(), 0);
-        return multi_source(g, src, kappa, validate, capper);
+        return multi_source(g, src, kappa, validate, capper, negative_cycle, ws);
     }
 
-    template <typename T>
-    ShortestPathTreeWitnessV2<T> artificial_source(
-        Graph<T> &g,
+    // lazy dijkstra from a virtual source, starting from the distances given by g.phi.
+    // sparse_seeding: see predetermined_initial_wit.
+    template <typename T, typename I>
+    ShortestPathTreeWitnessV2<T, I> artificial_source(
+        Graph<T, I> &g,
         size_t kappa,
         bool validate,
-        OperationCapper *capper = nullptr
+        OperationCapper *capper = nullptr,
+        NegativeCycleWitness *negative_cycle = nullptr,
+        Workspace<T, I> *ws = nullptr,
+        bool sparse_seeding = false
     ) {
-        ShortestPathTreeWitnessV2<T> wit(g.N());
-        wit.dist = g.phi;
-        for(auto &v : wit.dist) v = -v;
-        return predetermined_initial_wit(g, wit, kappa, validate, capper);
+        ShortestPathTreeWitnessV2<T, I> wit(0);
+        const auto &phi = as_const(g.phi);
+        wit.dist.resize(g.N());
+        for(size_t v = 0, n = g.N(); v < n; v++) wit.dist[v] = -phi[v];
+        wit.parent_edge_idx.assign(g.N(), I(-1));
+        return predetermined_initial_wit(g, move(wit), kappa, validate, capper, negative_cycle, ws, sparse_seeding);
     }
 } // lazy_dijkstra
\ No newline at end of file
@@ -39,4 +39,288 @@ TEST_CASE("all source sssp", "[validate]") {
     ShortestPathTreeWitnessV2<int> y = lazy_dijkstra::artificial_source(g, 10, false);
     
     REQUIRE( y.dist == vector<int>({1, 1, 0}) );
+}
+
+TEST_CASE("sparse seeding agrees with dense seeding", "[validate]") {
+    const size_t n = 300;
+    Graph<int> g(n);
+
+    mt19937 rng(0x5eed);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(-5, 40);
+
+    // backward edges are heavy enough that there is no negative cycle.
+    for(size_t i = 0; i < 4 * n; i++) {
+        size_t a = v(rng), b = v(rng);
+        int w = wt(rng);
+        if(a >= b) w = abs(w) + 5 * n;
+        g.add_edge(Edge<int>({a, b, w}));
+    }
+
+    // a potential that is right almost everywhere: exact distances, with a few vertices off.
+    auto exact = lazy_dijkstra::artificial_source(g, size_t(-1), false);
+    for(size_t x = 0; x < n; x++) g.phi.set(x, -exact.dist[x]);
+    for(size_t i = 0; i < 10; i++) g.phi.add(v(rng), 7);
+
+    NegativeCycleWitness cycle;
+    auto dense = lazy_dijkstra::artificial_source(g, size_t(-1), false, nullptr, &cycle);
+    REQUIRE( cycle.empty() );
+    auto sparse = lazy_dijkstra::artificial_source(g, size_t(-1), false, nullptr, &cycle, (Workspace<int> *) nullptr, true);
+    REQUIRE( cycle.empty() );
+
+    REQUIRE( sparse.dist == dense.dist );
+    REQUIRE( validate_shortest_path_tree(g, sparse) );
+
+    SECTION("negative cycle is extracted") {
+        g.add_edge(Edge<int>({250, 20, -100000}));
+        lazy_dijkstra::artificial_source(g, size_t(-1), false, nullptr, &cycle, (Workspace<int> *) nullptr, true);
+        REQUIRE( validate_negative_cycle(g, cycle) );
+    }
+
+    SECTION("a reused workspace gives the same trees") {
+        Workspace<int> ws;
+        for(int rep = 0; rep < 2; rep++) {
+            auto with_ws = lazy_dijkstra::artificial_source(g, size_t(-1), false, nullptr, &cycle, &ws, true);
+            REQUIRE( cycle.empty() );
+            REQUIRE( with_ws.dist == dense.dist );
+            REQUIRE( validate_shortest_path_tree(g, with_ws) );
+
+            with_ws = lazy_dijkstra::artificial_source(g, size_t(-1), false, nullptr, &cycle, &ws);
+            REQUIRE( with_ws.dist == dense.dist );
+
+            auto all = lazy_dijkstra::all_source(g, size_t(-1), false, nullptr, &cycle, &ws);
+            REQUIRE( all.dist == lazy_dijkstra::all_source(g, size_t(-1), false).dist );
+        }
+
+        g.add_edge(Edge<int>({250, 20, -100000}));
+        lazy_dijkstra::artificial_source(g, size_t(-1), false, nullptr, &cycle, &ws, true);
+        REQUIRE( validate_negative_cycle(g, cycle) );
+    }
+}
+
+TEST_CASE("lazy dijkstra extracts negative cycle", "[validate]") {
+    Graph<int> g(4);
+
+    g.add_edge({0, 1, 2});
+    g.add_edge({1, 2, -1});
+    g.add_edge({2, 3, 1});
+    g.add_edge({3, 1, -1});
+
+    NegativeCycleWitness cycle;
+    lazy_dijkstra::single_source(g, 0, size_t(-1), false, nullptr, &cycle);
+
+    REQUIRE( cycle.size() == 3 );
+    REQUIRE( validate_negative_cycle(g, cycle) );
+
+    g.set_weight(3, 0);
+    cycle.clear();
+    auto wit = lazy_dijkstra::single_source(g, 0, size_t(-1), false, nullptr, &cycle);
+
+    REQUIRE( cycle.empty() );
+    REQUIRE( validate_shortest_path_tree(g, wit) );
+}
+
+TEST_CASE("delta stepping agrees with dijkstra", "[delta_stepping]") {
+    const size_t n = 200;
+    Graph<int> g(n);
+
+    mt19937 rng(0x2468);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(0, 50);
+
+    for(size_t i = 0; i < 4 * n; i++) {
+        g.add_edge(Edge<int>({v(rng), v(rng), wt(rng)}));
+    }
+
+    auto expected = naive_dijkstra::single_source(g, 0, false);
+
+    for(size_t threads : {1, 4}) {
+        for(int delta : {0, 1, 7, 1000}) {
+            auto wit = delta_stepping::single_source(g, 0, false, nullptr, threads, delta);
+            REQUIRE( wit.dist == expected.dist );
+            REQUIRE( validate_shortest_path_tree(g, wit) );
+        }
+    }
+}
+
+TEST_CASE("delta stepping on frontiers above the parallel threshold", "[delta_stepping]") {
+    const size_t n = 3000;
+    Graph<int> g(n);
+
+    mt19937 rng(0x1357);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(0, 50);
+
+    // a hub puts most vertices into the first buckets at once.
+    for(size_t i = 1; i < n; i++) g.add_edge(Edge<int>({0, i, wt(rng)}));
+    for(size_t i = 0; i < 8 * n; i++) g.add_edge(Edge<int>({v(rng), v(rng), wt(rng)}));
+
+    auto expected = naive_dijkstra::single_source(g, 0, false);
+
+    for(int delta : {7, 1000}) {
+        auto wit = delta_stepping::single_source(g, 0, false, nullptr, 4, delta);
+        REQUIRE( wit.dist == expected.dist );
+        REQUIRE( validate_shortest_path_tree(g, wit) );
+    }
+}
+
+TEST_CASE("bellman ford variants agree", "[bellman_ford]") {
+    const size_t n = 100;
+    Graph<int> g(n);
+
+    mt19937 rng(0x1111);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(-30, 100);
+
+    // backward edges are heavy enough that there is no negative cycle.
+    for(size_t i = 0; i < 5 * n; i++) {
+        size_t a = v(rng), b = v(rng);
+        int w = wt(rng);
+        if(a >= b) w = abs(w) + 30 * n;
+        g.add_edge(Edge<int>({a, b, w}));
+    }
+
+    auto expected = bellman_ford::single_source(g, 0);
+
+    auto q = bellman_ford::spfa(g, {0});
+    REQUIRE( q.state == SHORTEST_PATH_TREE_FOUND );
+    REQUIRE( q.shortest_path_tree_witness.dist == expected.dist );
+    REQUIRE( q.validate(g) );
+
+    for(size_t threads : {1, 3}) {
+        auto p = bellman_ford::parallel_multi_source(g, {0}, threads);
+        REQUIRE( p.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( p.shortest_path_tree_witness.dist == expected.dist );
+        REQUIRE( p.validate(g) );
+    }
+
+    SECTION("negative cycle is extracted") {
+        g.add_edge(Edge<int>({90, 10, -10000}));
+
+        auto q = bellman_ford::spfa(g, {0});
+        REQUIRE( q.state == NEGATIVE_CYCLE_FOUND );
+        REQUIRE( q.validate(g) );
+
+        auto p = bellman_ford::parallel_multi_source(g, {0}, 2);
+        REQUIRE( p.state == NEGATIVE_CYCLE_FOUND );
+        REQUIRE( p.validate(g) );
+    }
+
+    SECTION("capper stops both on a negative cycle") {
+        g.add_edge(Edge<int>({90, 10, -10000}));
+
+        NormalOperationCapper cap(5);
+        REQUIRE( bellman_ford::spfa(g, {0}, &cap).state == UNKNOWN );
+
+        NormalOperationCapper cap2(5);
+        REQUIRE( bellman_ford::parallel_multi_source(g, {0}, 2, &cap2).state == UNKNOWN );
+    }
+}
+
+TEST_CASE("ball carving matches dijkstra", "[ball]") {
+    const size_t n = 150;
+    Graph<int> g(n);
+
+    mt19937 rng(0xba11);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(-2, 20);
+
+    for(size_t i = 0; i < 4 * n; i++) {
+        g.add_edge(Edge<int>({v(rng), v(rng), wt(rng)}));
+    }
+
+    // one workspace for every ball, as in _solve_rsssp.
+    Workspace<int> ws;
+    for(size_t src = 0; src < n; src += 7) {
+        auto wit = naive_dijkstra::single_source(g, src, true);
+        for(int r : {0, 5, 30}) {
+            auto [ball, boundary] = naive_dijkstra::get_ball_and_boundary(g, src, r, nullptr, &ws);
+
+            vector<size_t> expected_ball, expected_boundary;
+            for(size_t x = 0; x < n; x++) {
+                if(wit.dist[x] <= r) expected_ball.emplace_back(x);
+            }
+            for(size_t edge_idx = 0; edge_idx < g.M(); edge_idx++) {
+                const auto &e = g.edges[edge_idx];
+                if(g.weight(edge_idx) >= 0 && wit.dist[e.s] <= r && wit.dist[e.e] > r) expected_boundary.emplace_back(edge_idx);
+            }
+
+            sort(ball.begin(), ball.end());
+            sort(boundary.begin(), boundary.end());
+            REQUIRE( ball == expected_ball );
+            REQUIRE( boundary == expected_boundary );
+        }
+    }
+}
+
+TEST_CASE("bit parallel balls match dijkstra", "[ball]") {
+    const size_t n = 300;
+    Graph<int> g(n);
+
+    mt19937 rng(0xb175);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(-1, 4);
+
+    for(size_t i = 0; i < 3 * n; i++) {
+        g.add_edge(Edge<int>({v(rng), v(rng), wt(rng)}));
+    }
+
+    vector<uint64_t> mask(n, 0);
+    vector<size_t> touched;
+
+    for(size_t k : {1, 17, 64}) {
+        vector<size_t> src(k);
+        for(auto &s : src) s = v(rng);
+
+        for(int r : {0, 3, 8}) {
+            bit_parallel::ball_masks(g, src, r, mask, touched);
+
+            vector<uint64_t> expected(n, 0);
+            for(size_t i = 0; i < k; i++) {
+                auto wit = naive_dijkstra::single_source(g, src[i], true);
+                for(size_t x = 0; x < n; x++) {
+                    if(wit.dist[x] <= r) expected[x] |= uint64_t(1) << i;
+                }
+            }
+            REQUIRE( mask == expected );
+
+            size_t nonzero = count_if(mask.begin(), mask.end(), [](uint64_t m) { return m != 0; });
+            REQUIRE( touched.size() == nonzero );
+            for(auto x : touched) mask[x] = 0;
+        }
+    }
+}
+
+TEST_CASE("bidirectional dijkstra agrees with dijkstra", "[bidirectional]") {
+    const size_t n = 200;
+    Graph<int> g(n);
+
+    mt19937 rng(0xb1d1);
+    uniform_int_distribution<size_t> v(0, n - 1);
+    uniform_int_distribution<int> wt(0, 30);
+
+    for(size_t i = 0; i < 3 * n; i++) {
+        g.add_edge(Edge<int>({v(rng), v(rng), wt(rng)}));
+    }
+
+    Workspace<int> forward, backward;
+    for(size_t src : {0, 17, 123}) {
+        auto expected = naive_dijkstra::single_source(g, src, false);
+        for(size_t dst = 0; dst < n; dst++) {
+            auto [d, path] = bidirectional_dijkstra::single_target(g, src, dst, nullptr, &forward, &backward);
+            REQUIRE( d == expected.dist[dst] );
+
+            size_t at = src;
+            int len = 0;
+            for(auto edge_idx : path) {
+                REQUIRE( g.edges[edge_idx].s == at );
+                at = g.edges[edge_idx].e;
+                len += g.weight(edge_idx);
+            }
+            if(d != numeric_limits<int>::max()) {
+                REQUIRE( at == dst );
+                REQUIRE( len == d );
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "graph.hpp"
 #include "scc.hpp"
+#include "parallel.hpp"
+#include <random>
 
 // Shortest Path Algorithm Result State.
 enum ShortestPathState {
@@ -14,54 +16,64 @@ template <typename T>
 using ShortestPathTreeWitness = vector<T>;
 
 // Advanced shortest path tree witness with parent edge
-template <typename T>
+// I: edge index type of the graph, I(-1) means no parent edge.
+template <typename T, typename I = size_t>
 struct ShortestPathTreeWitnessV2 {
     vector<T> dist, pure_dist;
     // pure_dist : ignored potential
-    vector<size_t> parent_edge_idx;
+    vector<I> parent_edge_idx;
 
-    ShortestPathTreeWitnessV2(size_t n = 0) : dist(n), parent_edge_idx(n, size_t(-1)) {}
+    ShortestPathTreeWitnessV2(size_t n = 0) : dist(n), parent_edge_idx(n, I(-1)) {}
 };
 
 // negative cycle edge witness is edge idx.
 using NegativeCycleWitness = vector<size_t>;
 
-template <typename T>
+template <typename T, typename I = size_t>
 struct Witness {
     ShortestPathState state;
-    ShortestPathTreeWitnessV2<T> shortest_path_tree_witness;
+    ShortestPathTreeWitnessV2<T, I> shortest_path_tree_witness;
     NegativeCycleWitness negative_cycle_witness;
 
-    bool validate(Graph<T> &g) {
+    bool validate(Graph<T, I> &g, size_t num_threads = 1) {
         switch (state) {
             case UNKNOWN:
             return false;
             case SHORTEST_PATH_TREE_FOUND:
-            return validate_shortest_path_tree(g, shortest_path_tree_witness);
+            return validate_shortest_path_tree(g, shortest_path_tree_witness, num_threads);
             case NEGATIVE_CYCLE_FOUND:
             return validate_negative_cycle(g, negative_cycle_witness);
         }
     }
 };
 
-template <typename T>
-Witness<T> make_witness_for_sptree(const ShortestPathTreeWitnessV2<T> &wit) {
-    Witness<T> wt;
+template <typename T, typename I>
+Witness<T, I> make_witness_for_sptree(const ShortestPathTreeWitnessV2<T, I> &wit) {
+    Witness<T, I> wt;
     wt.state = SHORTEST_PATH_TREE_FOUND;
     wt.shortest_path_tree_witness = wit;
     return wt;
 }
 
+template <typename T, typename I = size_t>
+Witness<T, I> make_witness_for_negative_cycle(const NegativeCycleWitness &cycle) {
+    Witness<T, I> wt;
+    wt.state = NEGATIVE_CYCLE_FOUND;
+    wt.negative_cycle_witness = cycle;
+    return wt;
+}
+
 // validate_shortest_path_distance_map validates
 // if the shortest path tree (distance map) is valid.
 // Once this is broken, it might indicate the existence of a negative cycle.
-template <typename T>
+template <typename T, typename I>
 bool validate_shortest_path_distance_map(
-    Graph<T> &g,
+    Graph<T, I> &g,
     vector<T> &dist, 
     bool ignore_negative_edges=false
 ) {
-    for(auto e : g.edges) {
+    for(size_t edge_idx = 0, m = g.M(); edge_idx < m; edge_idx++) {
+        auto e = g.edge(edge_idx);
         if(ignore_negative_edges && g.get_weight(e) < T(0)) {
             continue;
         }
@@ -77,77 +89,194 @@ bool validate_shortest_path_distance_map(
     return true;
 }
 
-template <typename T>
+namespace internal {
+    // returns the index of some edge violating dist[e] <= dist[s] + w(e) (reduced weight),
+    // or size_t(-1) if there is none. Edges are scanned in parallel chunks.
+    template <typename T, typename I>
+    size_t find_violating_edge(
+        Graph<T, I> &g,
+        const vector<T> &dist,
+        size_t num_threads
+    ) {
+        const T INF = numeric_limits<T>::max();
+        vector<size_t> violation(max<size_t>(1, num_threads), size_t(-1));
+
+        const I *src = g.soa.src.data(), *dst = g.soa.dst.data();
+        const T *w = g.soa.w.data(), *phi = as_const(g.phi).data();
+        const T mult = g.potential_mult;
+
+        parallel_for(0, g.M(), num_threads, [&](size_t lo, size_t hi, size_t t) {
+            for(size_t edge_idx = lo; edge_idx < hi; edge_idx++) {
+                I s = src[edge_idx], e = dst[edge_idx];
+                T ds = dist[s];
+                if(ds != INF && dist[e] > ds + w[edge_idx] + mult * (phi[s] - phi[e])) {
+                    violation[t] = edge_idx;
+                    return;
+                }
+            }
+        });
+
+        return *min_element(violation.begin(), violation.end());
+    }
+
+    // walk_tree calls visit(edge_idx) for the parent edges of wit, each after the
+    // parent edge of its source: a DFS from every root (no parent edge, finite dist).
+    // The tree is stored flat (children bucketed by parent in one array) and walked
+    // with an explicit stack. Vertices on parent cycles are never reached.
+    // Returns false, visiting nothing, if a parent edge does not end at its vertex.
+    template <typename T, typename I, typename Visit>
+    bool walk_tree(Graph<T, I> &g, const ShortestPathTreeWitnessV2<T, I> &wit, Visit visit) {
+        const T INF = numeric_limits<T>::max();
+        size_t n = g.N();
+
+        // child_begin[v] .. child_begin[v+1] indexes child_edges of v.
+        vector<size_t> child_begin(n + 1, 0);
+        for(size_t i = 0; i < n; i++) {
+            I edge_idx = wit.parent_edge_idx[i];
+            if(edge_idx == I(-1)) continue;
+            if(g.edges[edge_idx].e != i) {
+                cerr << "parent edge " << edge_idx << " of " << i << " ends at " << g.edges[edge_idx].e << '\n';
+                return false;
+            }
+            ++child_begin[g.edges[edge_idx].s + 1];
+        }
+        for(size_t i = 0; i < n; i++) child_begin[i + 1] += child_begin[i];
+
+        vector<I> child_edges(child_begin[n]);
+        vector<size_t> fill = child_begin;
+        vector<size_t> stack;
+        stack.reserve(n);
+
+        for(size_t i = 0; i < n; i++) {
+            I edge_idx = wit.parent_edge_idx[i];
+            if(edge_idx != I(-1)) child_edges[fill[g.edges[edge_idx].s]++] = edge_idx;
+            else if(wit.dist[i] != INF) stack.emplace_back(i);
+        }
+
+        while(!stack.empty()) {
+            size_t f = stack.back(); stack.pop_back();
+            for(size_t k = child_begin[f]; k < child_begin[f + 1]; k++) {
+                visit(child_edges[k]);
+                stack.emplace_back(g.edges[child_edges[k]].e);
+            }
+        }
+        return true;
+    }
+}
+
+// Both validators below check one invariant on wit.dist, under the reduced weights
+// of g's current potential:
+//   - the parent edge of v ends at v and is tight: dist[v] = dist[s] + w(s, v),
+//   - no edge improves a finite distance: dist[e] <= dist[s] + w(s, e).
+// Roots may hold any finite distance, as if reached from an artificial source.
+
+// validate_shortest_path_tree checks the invariant on every vertex and edge in O(n + m),
+// and that the parent edges form a forest spanning exactly the finite distances.
+// The edge check runs on num_threads threads.
+// Distances from the roots (each at 0) with raw weights are stored in wit.pure_dist.
+template <typename T, typename I>
 bool validate_shortest_path_tree(
-    Graph<T> &g,
-    ShortestPathTreeWitnessV2<T> &wit
+    Graph<T, I> &g,
+    ShortestPathTreeWitnessV2<T, I> &wit,
+    size_t num_threads = 1
 ) {
+    const T INF = numeric_limits<T>::max();
     size_t n = g.N();
-    vector<size_t> src;
-    vector<vector<size_t>> child_edges(n);
-    vector<T> dist = g.initial_dist();
-
-    cerr << "parent edge indices:\n"; 
-    for(auto pe : wit.parent_edge_idx) {
-        if(pe == size_t(-1)) cerr << "-1\n";
-        else cerr << pe << ' ' << g.edges[pe].s << " -> " << g.edges[pe].e << "(" << g.edges[pe].w << ")\n";
+    if(wit.dist.size() != n || wit.parent_edge_idx.size() != n) return false;
+
+    vector<T> pure(n, INF);
+    for(size_t i = 0; i < n; i++) {
+        if(wit.parent_edge_idx[i] == I(-1) && wit.dist[i] != INF) pure[i] = T(0);
     }
-    cerr << '\n';
+
+    bool tight = true;
+    bool walked = internal::walk_tree(g, wit, [&](size_t edge_idx) {
+        const auto &e = g.edges[edge_idx];
+        pure[e.e] = pure[e.s] + g.weight(edge_idx);
+        if(wit.dist[e.e] != wit.dist[e.s] + g.get_weight(edge_idx)) {
+            if(tight) cerr << "parent edge " << edge_idx << " of " << e.e << " is not tight\n";
+            tight = false;
+        }
+    });
+    if(!walked || !tight) return false;
 
     for(size_t i = 0; i < n; i++) {
         if(
-            size_t edge_idx = wit.parent_edge_idx[i];
-            edge_idx == size_t(-1)
+            (wit.dist[i] == INF) != (pure[i] == INF) // reachability does not agree
         ) {
-            if(wit.dist[i] != numeric_limits<T>::max()) {
-                src.emplace_back(i);
-            }
-        } else {
-            auto parent_v = g.edges[edge_idx].s;
-            child_edges[parent_v].emplace_back(edge_idx);
+            cerr << i << " is reachable?: wit=" << wit.dist[i] << ", tree=" << pure[i] << "\n"; 
+            return false;
         }
     }
 
-    queue<size_t> q;
-
-    for(size_t s : src) {
-        dist[s] = T(0); // ignore potential
-        q.emplace(s);
+    size_t bad = internal::find_violating_edge(g, wit.dist, num_threads);
+    if(bad != size_t(-1)) {
+        auto e = g.edge(bad);
+        cerr << "dist[" << e.s << "] = " 
+        << wit.dist[e.s] << " -> dist[" << e.e << "] = " << wit.dist[e.e] 
+        << ", but there is an edge with weight " 
+        << g.get_weight(e) << " violating the shortest path tree\n";
     }
 
-    cerr << "validating: initial bfs setup done\n";
-    g.ignore_potential();
+    wit.pure_dist = move(pure);
+    return bad == size_t(-1);
+}
 
-    while(!q.empty()) {
-        int f = q.front(); q.pop();
-        assert(dist[f] != numeric_limits<T>::max());
-        for(auto ch : child_edges[f]) {
-            auto e = g.edges[ch];
-            dist[e.e] = dist[e.s] + g.get_weight(e);
-            q.emplace(e.e);
+// tree_distances rewrites wit.dist along its parent edges under the reduced weights
+// of g, keeping the distance of every root. For trees found on a graph with the same
+// edges but other weights or potential (e.g. a scaled copy), before validating on g.
+template <typename T, typename I>
+void tree_distances(Graph<T, I> &g, ShortestPathTreeWitnessV2<T, I> &wit) {
+    internal::walk_tree(g, wit, [&](size_t edge_idx) {
+        const auto &e = g.edges[edge_idx];
+        wit.dist[e.e] = wit.dist[e.s] + g.get_weight(edge_idx);
+    });
+}
+
+// spot_check_shortest_path_tree is a probabilistic, O(samples) version of
+// validate_shortest_path_tree: the invariant is checked on random vertices and
+// random edges only, and parent cycles go unnoticed. It never fills wit.pure_dist.
+template <typename T, typename I, typename RNG>
+bool spot_check_shortest_path_tree(
+    Graph<T, I> &g,
+    ShortestPathTreeWitnessV2<T, I> &wit,
+    size_t samples,
+    RNG &rng
+) {
+    const T INF = numeric_limits<T>::max();
+    size_t n = g.N(), m = g.M();
+    if(n == 0) return true;
+    if(wit.dist.size() != n || wit.parent_edge_idx.size() != n) return false;
+
+    uniform_int_distribution<size_t> vertex_sampler(0, n - 1);
+    for(size_t i = 0; i < samples; i++) {
+        size_t v = vertex_sampler(rng);
+        I edge_idx = wit.parent_edge_idx[v];
+        if(edge_idx == I(-1)) continue;
+
+        const auto &e = g.edges[edge_idx];
+        if(e.e != v || wit.dist[e.s] == INF || wit.dist[v] != wit.dist[e.s] + g.get_weight(size_t(edge_idx))) {
+            return false;
         }
     }
 
-    for(size_t i = 0; i < n; i++) {
-        if(
-            (wit.dist[i] == numeric_limits<T>::max())
-            != (dist[i] == numeric_limits<T>::max()) // reachability does not agree
-        ) {
-            cerr << i << " is reachable?: wit=" << wit.dist[i] << ", dist=" << dist[i] << "\n"; 
+    if(m == 0) return true;
+    uniform_int_distribution<size_t> edge_sampler(0, m - 1);
+    for(size_t i = 0; i < samples; i++) {
+        size_t edge_idx = edge_sampler(rng);
+        const auto &e = g.edges[edge_idx];
+        if(wit.dist[e.s] != INF && wit.dist[e.e] > wit.dist[e.s] + g.get_weight(edge_idx)) {
             return false;
         }
     }
 
-    bool ret = validate_shortest_path_distance_map(g, dist);
-    g.regard_potential();
-    wit.pure_dist = dist;
-    return ret;
+    return true;
 }
 
 // validate_negative_cycle validates if negative cycle is truly negative.
-template <typename T>
+template <typename T, typename I>
 bool validate_negative_cycle(
-    Graph<T> &g,
+    Graph<T, I> &g,
     vector<size_t> &negative_cycle
 ) {
     if(negative_cycle.empty()) {
@@ -162,7 +291,7 @@ bool validate_negative_cycle(
         assert(previous_end == edge.s);
         previous_end = edge.e;
 
-        weight += edge.w;
+        weight += g.weight(edge_idx);
     }
 
     return weight < 0;
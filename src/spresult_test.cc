@@ -18,7 +18,14 @@ TEST_CASE("validate_shortest_path_distance_map", "[validate]") {
 
     SECTION("phi manipulated distance map should succeed") {
         G.phi = vector<int>({1, 2, 3, 2}); // arbitrarily re-assign potentials
+        REQUIRE_FALSE( validate_shortest_path_tree(G, v) ); // distances are stale
+
+        tree_distances(G, v);
         REQUIRE( validate_shortest_path_tree(G, v) );
+        REQUIRE( v.pure_dist == vector<int>({0, 2, 3, 2}) );
+
+        mt19937_64 rng(0x1234);
+        REQUIRE( spot_check_shortest_path_tree(G, v, 64, rng) );
     }
 }
 
@@ -33,6 +40,58 @@ TEST_CASE("validate_negative_cycle", "[validate]") {
 
     REQUIRE( validate_negative_cycle(G, neg_cycle) );
 
-    G.edges[2].w = 3;
+    G.set_weight(2, 3);
     REQUIRE_FALSE( validate_negative_cycle(G, neg_cycle) );
-}
\ No newline at end of file
+}
+
+TEST_CASE("validate_shortest_path_tree on a broken tree", "[validate]") {
+    Graph<int> G(4);
+
+    G.add_edge(Edge<int>({0, 1, 2}));
+    G.add_edge(Edge<int>({1, 2, 1}));
+    G.add_edge(Edge<int>({0, 2, 1}));
+    G.add_edge(Edge<int>({2, 3, -1}));
+
+    ShortestPathTreeWitnessV2<int> v = bellman_ford::single_source(G, 0);
+
+    SECTION("flat validator agrees with bellman-ford") {
+        REQUIRE( validate_shortest_path_tree(G, v, 4) );
+        REQUIRE( v.pure_dist == vector<int>({0, 2, 1, 0}) );
+    }
+
+    SECTION("non-shortest parent is rejected") {
+        v.parent_edge_idx[2] = 1;
+        v.dist[2] = 3;
+        REQUIRE_FALSE( validate_shortest_path_tree(G, v) );
+
+        mt19937_64 rng(0x1234);
+        REQUIRE_FALSE( spot_check_shortest_path_tree(G, v, 64, rng) );
+    }
+
+    SECTION("parent edge ending elsewhere is rejected") {
+        v.parent_edge_idx[3] = 2; // 0 -> 2, not into 3
+        v.dist[3] = v.dist[2] + 1;
+        REQUIRE_FALSE( validate_shortest_path_tree(G, v) );
+
+        mt19937_64 rng(0x1234);
+        REQUIRE_FALSE( spot_check_shortest_path_tree(G, v, 64, rng) );
+    }
+
+    SECTION("both validators reject a loose distance on a multi-root tree") {
+        // roots 0 and 2: 2's distance is not improved by 0 -> 2 in either mode.
+        v.parent_edge_idx[2] = size_t(-1);
+        v.dist[2] = 5;
+        v.dist[3] = 4;
+        REQUIRE_FALSE( validate_shortest_path_tree(G, v) );
+
+        mt19937_64 rng(0x1234);
+        REQUIRE_FALSE( spot_check_shortest_path_tree(G, v, 64, rng) );
+    }
+
+    SECTION("parent cycle is rejected") {
+        G.add_edge(Edge<int>({2, 0, 5}));
+        v.parent_edge_idx[0] = 4; // 0 -> 2 -> 0
+        v.dist[0] = 6;
+        REQUIRE_FALSE( validate_shortest_path_tree(G, v) );
+    }
+}
@@ -0,0 +1,257 @@
+// Compact shortest path tree for path queries.
+// The tree of a ShortestPathTreeWitnessV2 is laid out in DFS preorder: a subtree is
+// a contiguous range of positions, so ancestor tests are O(1), paths are parent-position
+// walks over adjacent memory, and the k-th ancestor is a binary search in one depth level.
+// The arrays can be dumped as one binary blob and queried in place (CompactTreeView).
+#pragma once
+#include "graph.hpp"
+#include "spresult.hpp"
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// CompactTreeView queries a compact tree through raw arrays, owned elsewhere:
+// by a CompactTree, or by a buffer holding its dump (e.g. a mmap-ed file).
+// Positions are DFS preorder indices; vertices are vertex indices of the graph.
+template <typename T, typename I = size_t>
+struct CompactTreeView {
+    size_t n = 0;      // vertices of the graph
+    size_t nodes = 0;  // vertices on the tree (reachable ones)
+    size_t levels = 0; // 1 + maximum depth, 0 for an empty tree
+
+    const I *vertex = nullptr;      // position -> vertex
+    const I *parent_pos = nullptr;  // position -> position of the parent, I(-1) for roots
+    const I *parent_edge = nullptr; // position -> edge from the parent, I(-1) for roots
+    const I *depth = nullptr;       // position -> number of edges from its root
+    const I *subtree_end = nullptr; // position -> end (exclusive) of its subtree
+    const T *dist = nullptr;        // position -> distance
+    const I *pos = nullptr;         // vertex -> position, I(-1) if unreachable
+    const I *level_begin = nullptr; // depth d -> level_nodes[level_begin[d] .. level_begin[d + 1])
+    const I *level_nodes = nullptr; // positions grouped by depth, increasing within a depth
+
+    bool reachable(size_t v) const { return pos[v] != I(-1); }
+
+    T distance(size_t v) const {
+        return reachable(v) ? dist[pos[v]] : numeric_limits<T>::max();
+    }
+
+    // is u on the tree path to v (u == v included)?
+    bool is_ancestor(size_t u, size_t v) const {
+        if(!reachable(u) || !reachable(v)) return false;
+        return pos[u] <= pos[v] && pos[v] < subtree_end[pos[u]];
+    }
+
+    // the vertex k edges above v, or size_t(-1) if there is none. O(log n).
+    size_t kth_ancestor(size_t v, size_t k) const {
+        if(!reachable(v) || k > depth[pos[v]]) return size_t(-1);
+        size_t d = depth[pos[v]] - k;
+        // the ancestor at depth d is the last node of level d before v in preorder.
+        const I *first = level_nodes + level_begin[d], *last = level_nodes + level_begin[d + 1];
+        const I *it = upper_bound(first, last, pos[v]);
+        return vertex[*(it - 1)];
+    }
+
+    // edge indices of the tree path from the root of v to v, in path order.
+    vector<size_t> path_edges(size_t v) const {
+        if(!reachable(v)) return vector<size_t>();
+        vector<size_t> ret(depth[pos[v]]);
+        size_t p = pos[v];
+        for(size_t i = ret.size(); i-- > 0; p = parent_pos[p]) ret[i] = parent_edge[p];
+        return ret;
+    }
+
+    // vertices of the tree path from the root of v to v, in path order.
+    vector<size_t> path_vertices(size_t v) const {
+        if(!reachable(v)) return vector<size_t>();
+        vector<size_t> ret(depth[pos[v]] + 1);
+        size_t p = pos[v];
+        for(size_t i = ret.size(); i-- > 0; p = parent_pos[p]) ret[i] = vertex[p];
+        return ret;
+    }
+};
+
+namespace internal {
+    // binary layout of a compact tree dump: this header, then the arrays of
+    // CompactTreeView in declaration order, each padded to a multiple of 8 bytes.
+    struct CompactTreeHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t index_bytes, weight_bytes;
+        uint64_t n, nodes, levels;
+    };
+
+    constexpr char COMPACT_TREE_MAGIC[4] = {'B', 'C', 'F', 'T'};
+    constexpr uint32_t COMPACT_TREE_VERSION = 1;
+
+    inline size_t pad8(size_t bytes) {
+        return (bytes + 7) / 8 * 8;
+    }
+}
+
+// CompactTree owns the arrays of a compact tree. Build it with compact_tree().
+template <typename T, typename I = size_t>
+struct CompactTree {
+    size_t n = 0;
+    vector<I> vertex, parent_pos, parent_edge, depth, subtree_end, pos, level_begin, level_nodes;
+    vector<T> dist;
+
+    CompactTreeView<T, I> view() const {
+        CompactTreeView<T, I> v;
+        v.n = n;
+        v.nodes = vertex.size();
+        v.levels = level_begin.empty() ? 0 : level_begin.size() - 1;
+        v.vertex = vertex.data();
+        v.parent_pos = parent_pos.data();
+        v.parent_edge = parent_edge.data();
+        v.depth = depth.data();
+        v.subtree_end = subtree_end.data();
+        v.dist = dist.data();
+        v.pos = pos.data();
+        v.level_begin = level_begin.data();
+        v.level_nodes = level_nodes.data();
+        return v;
+    }
+
+    // dump writes the binary layout read by view_compact_tree.
+    void dump(ostream &out) const {
+        internal::CompactTreeHeader h;
+        memcpy(h.magic, internal::COMPACT_TREE_MAGIC, 4);
+        h.version = internal::COMPACT_TREE_VERSION;
+        h.index_bytes = sizeof(I);
+        h.weight_bytes = sizeof(T);
+        h.n = n;
+        h.nodes = vertex.size();
+        h.levels = level_begin.empty() ? 0 : level_begin.size() - 1;
+
+        const char zeros[8] = {};
+        auto write_array = [&](const void *data, size_t bytes) {
+            out.write((const char *) data, bytes);
+            out.write(zeros, internal::pad8(bytes) - bytes);
+        };
+
+        write_array(&h, sizeof(h));
+        for(auto *a : {&vertex, &parent_pos, &parent_edge, &depth, &subtree_end}) {
+            write_array(a->data(), a->size() * sizeof(I));
+        }
+        write_array(dist.data(), dist.size() * sizeof(T));
+        for(auto *a : {&pos, &level_begin, &level_nodes}) {
+            write_array(a->data(), a->size() * sizeof(I));
+        }
+    }
+};
+
+// view_compact_tree reads a dump in place. data must be 8-byte aligned and
+// outlive the view. Returns false if the buffer is not a dump of this T and I.
+template <typename T, typename I>
+bool view_compact_tree(const void *data, size_t size, CompactTreeView<T, I> &v) {
+    internal::CompactTreeHeader h;
+    if(size < sizeof(h)) return false;
+    memcpy(&h, data, sizeof(h));
+    if(
+        memcmp(h.magic, internal::COMPACT_TREE_MAGIC, 4) != 0
+        || h.version != internal::COMPACT_TREE_VERSION
+        || h.index_bytes != sizeof(I)
+        || h.weight_bytes != sizeof(T)
+    ) return false;
+
+    const char *p = (const char *) data, *end = p + size;
+    p += internal::pad8(sizeof(h));
+
+    bool ok = true;
+    auto take = [&](auto *&array, size_t count) {
+        size_t bytes = count * sizeof(*array);
+        if(size_t(end - p) < bytes) {
+            ok = false;
+            return;
+        }
+        array = (remove_reference_t<decltype(array)>) p;
+        p += min(size_t(end - p), internal::pad8(bytes));
+    };
+
+    v.n = h.n;
+    v.nodes = h.nodes;
+    v.levels = h.levels;
+    take(v.vertex, h.nodes);
+    take(v.parent_pos, h.nodes);
+    take(v.parent_edge, h.nodes);
+    take(v.depth, h.nodes);
+    take(v.subtree_end, h.nodes);
+    take(v.dist, h.nodes);
+    take(v.pos, h.n);
+    take(v.level_begin, h.levels + 1);
+    take(v.level_nodes, h.nodes);
+    return ok;
+}
+
+// compact_tree lays out the parent-edge tree of wit in DFS preorder, in O(n).
+// Distances are wit.pure_dist if it is filled, wit.dist otherwise.
+// Vertices with infinite distance and no parent edge are left out.
+template <typename T, typename I>
+CompactTree<T, I> compact_tree(Graph<T, I> &g, const ShortestPathTreeWitnessV2<T, I> &wit) {
+    const T INF = numeric_limits<T>::max();
+    const auto &d = wit.pure_dist.empty() ? wit.dist : wit.pure_dist;
+    size_t n = g.N();
+
+    CompactTree<T, I> t;
+    t.n = n;
+    t.pos.assign(n, I(-1));
+
+    // children by parent, flat (see validate_shortest_path_tree).
+    vector<size_t> child_begin(n + 1, 0);
+    for(size_t v = 0; v < n; v++) {
+        I edge_idx = wit.parent_edge_idx[v];
+        if(edge_idx != I(-1)) ++child_begin[g.edges[edge_idx].s + 1];
+    }
+    for(size_t v = 0; v < n; v++) child_begin[v + 1] += child_begin[v];
+    vector<I> children(child_begin[n]);
+    vector<size_t> fill(child_begin.begin(), child_begin.end() - 1);
+    for(size_t v = 0; v < n; v++) {
+        I edge_idx = wit.parent_edge_idx[v];
+        if(edge_idx != I(-1)) children[fill[g.edges[edge_idx].s]++] = v;
+    }
+
+    // iterative preorder DFS; a stack entry is (position, next child index).
+    vector<pair<size_t, size_t>> stack;
+    auto visit = [&](size_t v, size_t parent) {
+        size_t p = t.vertex.size();
+        t.pos[v] = p;
+        t.vertex.emplace_back(v);
+        t.parent_pos.emplace_back(parent == size_t(-1) ? I(-1) : I(parent));
+        t.parent_edge.emplace_back(wit.parent_edge_idx[v]);
+        t.depth.emplace_back(parent == size_t(-1) ? 0 : t.depth[parent] + 1);
+        t.subtree_end.emplace_back(p + 1);
+        t.dist.emplace_back(d[v]);
+        stack.emplace_back(p, child_begin[v]);
+    };
+
+    for(size_t root = 0; root < n; root++) {
+        if(wit.parent_edge_idx[root] != I(-1) || d[root] == INF) continue;
+        visit(root, size_t(-1));
+        while(!stack.empty()) {
+            auto &[p, k] = stack.back();
+            size_t v = t.vertex[p];
+            if(k < child_begin[v + 1]) {
+                visit(children[k++], p);
+                continue;
+            }
+            t.subtree_end[p] = t.vertex.size();
+            stack.pop_back();
+        }
+    }
+
+    // positions by depth, increasing within each depth since they are visited in order.
+    size_t levels = 0;
+    for(auto dep : t.depth) levels = max<size_t>(levels, dep + 1);
+    t.level_begin.assign(levels + 1, 0);
+    for(auto dep : t.depth) ++t.level_begin[dep + 1];
+    for(size_t l = 0; l < levels; l++) t.level_begin[l + 1] += t.level_begin[l];
+    t.level_nodes.resize(t.vertex.size());
+    vector<size_t> level_fill(t.level_begin.begin(), t.level_begin.end() - 1);
+    for(size_t p = 0; p < t.vertex.size(); p++) t.level_nodes[level_fill[t.depth[p]]++] = p;
+
+    return t;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "sptree.hpp"
+#include "spalgo.hpp"
+#include "catch2/catch_all.hpp"
+#include <sstream>
+
+using namespace std;
+
+// root 0 with children 1 and 4, 1 -> 2 -> 3, and 5 unreachable.
+Graph<int> small_tree_graph() {
+    Graph<int> g(6);
+    g.add_edge({0, 1, 2});
+    g.add_edge({1, 2, 3});
+    g.add_edge({2, 3, -1});
+    g.add_edge({0, 4, 7});
+    g.add_edge({4, 3, 5});
+    return g;
+}
+
+TEST_CASE("compact tree path queries", "[sptree]") {
+    auto g = small_tree_graph();
+    auto wit = bellman_ford::single_source(g, 0);
+    auto t = compact_tree(g, wit);
+    auto v = t.view();
+
+    REQUIRE( v.nodes == 5 );
+    REQUIRE_FALSE( v.reachable(5) );
+    REQUIRE( v.distance(3) == 4 );
+    REQUIRE( v.distance(5) == numeric_limits<int>::max() );
+
+    REQUIRE( v.path_edges(3) == vector<size_t>({0, 1, 2}) );
+    REQUIRE( v.path_vertices(3) == vector<size_t>({0, 1, 2, 3}) );
+    REQUIRE( v.path_edges(0).empty() );
+
+    REQUIRE( v.kth_ancestor(3, 0) == 3 );
+    REQUIRE( v.kth_ancestor(3, 2) == 1 );
+    REQUIRE( v.kth_ancestor(3, 3) == 0 );
+    REQUIRE( v.kth_ancestor(3, 4) == size_t(-1) );
+    REQUIRE( v.kth_ancestor(4, 1) == 0 );
+
+    REQUIRE( v.is_ancestor(1, 3) );
+    REQUIRE( v.is_ancestor(0, 4) );
+    REQUIRE_FALSE( v.is_ancestor(4, 3) );
+    REQUIRE_FALSE( v.is_ancestor(3, 1) );
+}
+
+TEST_CASE("compact tree agrees with parent walks", "[sptree]") {
+    Graph<int> g(200);
+    mt19937 rng(0x7ee);
+    uniform_int_distribution<size_t> vs(0, 199);
+    uniform_int_distribution<int> wt(0, 30);
+    for(int i = 0; i < 600; i++) g.add_edge(Edge<int>({vs(rng), vs(rng), wt(rng)}));
+
+    auto wit = naive_dijkstra::single_source(g, 0, false);
+    auto t = compact_tree(g, wit);
+    auto v = t.view();
+
+    for(size_t x = 0; x < g.N(); x++) {
+        if(wit.dist[x] == numeric_limits<int>::max()) {
+            REQUIRE_FALSE( v.reachable(x) );
+            continue;
+        }
+        vector<size_t> walk;
+        for(size_t y = x; wit.parent_edge_idx[y] != size_t(-1); y = g.edges[wit.parent_edge_idx[y]].s) {
+            walk.emplace_back(wit.parent_edge_idx[y]);
+        }
+        reverse(walk.begin(), walk.end());
+        REQUIRE( v.path_edges(x) == walk );
+        REQUIRE( v.distance(x) == wit.dist[x] );
+        for(size_t k = 0; k <= walk.size(); k++) {
+            size_t expected = k == walk.size() ? 0 : g.edges[walk[walk.size() - 1 - k]].e;
+            REQUIRE( v.kth_ancestor(x, k) == expected );
+        }
+    }
+}
+
+TEST_CASE("compact tree binary dump", "[sptree]") {
+    auto g = small_tree_graph();
+    auto t = compact_tree(g, bellman_ford::single_source(g, 0));
+
+    ostringstream out;
+    t.dump(out);
+    string blob = out.str();
+    REQUIRE( blob.size() % 8 == 0 );
+
+    // queried in place, from an 8-byte aligned copy of the dump.
+    vector<uint64_t> buffer(blob.size() / 8);
+    memcpy(buffer.data(), blob.data(), blob.size());
+
+    CompactTreeView<int> v;
+    REQUIRE( view_compact_tree(buffer.data(), blob.size(), v) );
+    REQUIRE( v.path_edges(3) == vector<size_t>({0, 1, 2}) );
+    REQUIRE( v.kth_ancestor(3, 2) == 1 );
+    REQUIRE( v.distance(4) == 7 );
+    REQUIRE_FALSE( v.reachable(5) );
+
+    CompactTreeView<int, uint32_t> wrong_index;
+    REQUIRE_FALSE( view_compact_tree(buffer.data(), blob.size(), wrong_index) );
+    REQUIRE_FALSE( view_compact_tree(buffer.data(), blob.size() - 16, v) );
+}
\ No newline at end of file
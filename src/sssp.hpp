@@ -3,95 +3,238 @@
 # pragma once
 #include "graph.hpp"
 #include "config.hpp"
+#include "reorder.hpp"
 #include "rsssp.hpp"
+#include "simplify.hpp"
 #include "spresult.hpp"
 
-// ceil div function with b > 0
-template <typename T>
-T __div_ceil(T a, T b) {
-    if(a >= 0) return (a + b - 1) / b;
-    return -( (-a) / b );
-}
-
 // one_step_scaling decreases the magnitude of negative weight by 2/3,
 // if no negative cycle is given. It'll be inserted on 
 // time budget is controlled by the capper.
-template <typename T>
-void one_step_scaling(
-    Graph<T> &g,
-    SSSPConfig &cfg
+// @return a negative cycle of g (edge indices), if the restricted solver found one.
+template <typename T, typename I>
+NegativeCycleWitness one_step_scaling(
+    Graph<T, I> &g,
+    SSSPConfig &cfg,
+    Workspace<T, I> *ws = nullptr
 ) {
-    T min_weight = g.get_min_edge_weight();
+    T min_weight = g.get_min_edge_weight(cfg.num_threads);
 
     // no need to run on minw >= -3 graph
-    if(min_weight >= -3) return;
+    if(min_weight >= -3) return NegativeCycleWitness();
 
     // generate restricted graph
     T W = (-min_weight) / 3 + 1;
 
     cerr << "W = " << W << endl;
 
-    Graph<int> h = g;
-
-    for(auto &e : h.edges) {
-        e.w = __div_ceil(e.w, W) + 1;
-    }
+    Graph<T, I> h = g;
+    h.ceil_div_weights(W, T(1), cfg.num_threads);
 
     cerr << "g: " << g.get_min_edge_weight() << ", h: " << h.get_min_edge_weight() << endl;
 
-    Witness<T> wit = solve_rsssp(h, cfg);
+    // h.s weights are about 3 * max / -min in magnitude: often a narrow type holds them.
+    Witness<T, I> wit = cfg.narrow_weights ? solve_rsssp_narrow(h, cfg, ws) : solve_rsssp(h, cfg, ws);
 
-    if(!wit.validate(h)) {
+    // h has the edges of g in the same order, and a cycle negative in h
+    // (h >= w / W) is negative in g as well.
+    if(wit.state == NEGATIVE_CYCLE_FOUND) {
+        return wit.negative_cycle_witness;
+    }
+
+    // the top level of solve_rsssp has already filled pure_dist, unless the policy skipped it.
+    if(
+        wit.state != SHORTEST_PATH_TREE_FOUND
+        || (wit.shortest_path_tree_witness.pure_dist.empty() && !wit.validate(h, cfg.num_threads))
+    ) {
         assert(cfg.capper -> fail());
-        return;
+        return NegativeCycleWitness();
     }
 
     assert(wit.state == SHORTEST_PATH_TREE_FOUND);
     for(size_t i = 0; i < g.N(); i++) {
-        g.phi[i] += W * (wit.shortest_path_tree_witness.pure_dist[i]);
+        g.phi.add(i, W * (wit.shortest_path_tree_witness.pure_dist[i]));
     }
+
+    return NegativeCycleWitness();
 }
 
-// sssp solves single source shortest path problem.
-template <typename T>
-Witness<T> sssp(
-    Graph<T> g,
-    size_t src,
-    SSSPConfig &cfg
+// nonnegative_reweighting makes h a copy of g with scaled weights and a potential
+// under which every reduced weight is non-negative, and a shortest path of h is one of g.
+// @return SHORTEST_PATH_TREE_FOUND (with an empty tree) on success,
+// or the negative cycle / UNKNOWN witness to report for g.
+template <typename T, typename I>
+Witness<T, I> nonnegative_reweighting(
+    Graph<T, I> &g,
+    Graph<T, I> &h,
+    SSSPConfig &cfg,
+    Workspace<T, I> *ws = nullptr
 ) {
+    // one workspace for every round, so they share its buffers and cached transpose.
+    Workspace<T, I> local_ws;
+    if(ws == nullptr) ws = &local_ws;
+
     // initial multiplication
     size_t n = g.N();
-    Graph<T> h = g;
+    h = g;
+    h.cache_reduced_weights = cfg.cache_reduced_weights;
 
     T weight_mult = 4 * n;
-    for(auto &phi : h.phi) {
-        phi *= weight_mult;
-    }
-    for(auto &e : h.edges) {
-        e.w *= weight_mult;
-    }
+    kernels::scale(h.phi.mutable_data(), weight_mult, n, cfg.num_threads);
+    h.phi.touch();
+    h.scale_weights(weight_mult, cfg.num_threads);
     // scale before sssp
-    while(h.get_min_edge_weight() < T(-3)) {
-        one_step_scaling(h, cfg);
-        h.flush_potential();
-        if(cfg.capper -> fail()) return Witness<T>();
+    while(h.get_min_edge_weight(cfg.num_threads) < T(-3)) {
+        auto cycle = one_step_scaling(h, cfg, ws);
+        // edge indices of h are those of g.
+        if(!cycle.empty()) return make_witness_for_negative_cycle<T, I>(cycle);
+        h.flush_potential(cfg.num_threads);
+        if(cfg.capper -> fail()) return Witness<T, I>();
     }
 
     cerr << "one-step scaling done. " << h.get_min_edge_weight() << '\n';
 
-    Witness<T> wit;
+    // weights were multiplied by 4n, so adding 3 to every edge (< 3n on a simple path)
+    // cannot change which path is shortest in g, and makes every weight non-negative.
+    h.shift_weights(T(3), cfg.num_threads);
+
+    Witness<T, I> wit;
     wit.state = SHORTEST_PATH_TREE_FOUND;
+    return wit;
+}
+
+// sssp solves single source shortest path problem.
+// ws: optional scratch space, kept by the caller across calls.
+template <typename T, typename I>
+Witness<T, I> sssp(
+    Graph<T, I> g,
+    size_t src,
+    SSSPConfig &cfg,
+    Workspace<T, I> *ws = nullptr
+) {
+    // solve on what src reaches only, and leave the rest at infinite distance.
+    if(cfg.prune_unreachable) {
+        auto r = reachable_subgraph(g, src);
+        if(r.graph.N() < g.N()) {
+            cfg.prune_unreachable = false;
+            auto wit = sssp(r.graph, 0, cfg, ws);
+            cfg.prune_unreachable = true;
+
+            return r.lift(wit);
+        }
+    }
+
+    // drop parallel edges and self-loops; a negative self-loop is the answer already.
+    if(cfg.simplify_multigraph) {
+        NegativeCycleWitness self_loop;
+        auto r = simplify(g, &self_loop);
+        if(!self_loop.empty()) return make_witness_for_negative_cycle<T, I>(self_loop);
+        if(r.graph.M() < g.M()) {
+            cfg.simplify_multigraph = false;
+            auto wit = sssp(r.graph, src, cfg, ws);
+            cfg.simplify_multigraph = true;
+
+            return r.lift(wit);
+        }
+    }
+
+    // relabel for locality, solve, and translate the witness back.
+    if(cfg.vertex_order != ORDER_NONE) {
+        auto order = cfg.vertex_order;
+        auto r = reorder(g, order);
 
-    ShortestPathTreeWitnessV2<T> swit = naive_dijkstra::single_source(
-        h,
-        src,
-        true,
-        cfg.capper
-    );
+        cfg.vertex_order = ORDER_NONE;
+        auto wit = sssp(r.graph, r.vertex_down_map[src], cfg, ws);
+        cfg.vertex_order = order;
 
-    wit.shortest_path_tree_witness = swit;
+        return r.lift(wit);
+    }
+
+    size_t n = g.N();
+    Graph<T, I> h(0);
+    Witness<T, I> wit = nonnegative_reweighting(g, h, cfg, ws);
+    if(wit.state != SHORTEST_PATH_TREE_FOUND) return wit;
+
+    if(cfg.engine == ENGINE_DELTA_STEPPING) {
+        wit.shortest_path_tree_witness = delta_stepping::single_source(h, src, true, cfg.capper, cfg.num_threads);
+    } else if(ws != nullptr) {
+        naive_dijkstra::multi_source_sparse(h, vector<size_t>({src}), true, *ws, cfg.capper);
+        wit.shortest_path_tree_witness = ws->witness(n);
+    } else {
+        wit.shortest_path_tree_witness = naive_dijkstra::single_source(h, src, true, cfg.capper);
+    }
 
-    if(!wit.validate(g)) return Witness<T>();
+    // the tree was found on h: validate it with the distances it has on g.
+    tree_distances(g, wit.shortest_path_tree_witness);
+    if(!wit.validate(g, cfg.num_threads)) return Witness<T, I>();
 
     return wit;
+}
+
+// TargetPaths holds the shortest paths from one source to a few targets.
+template <typename T, typename I = size_t>
+struct TargetPaths {
+    ShortestPathState state = UNKNOWN;
+    vector<T> dist;          // per target, numeric_limits<T>::max() if unreachable
+    vector<vector<I>> paths; // per target, edge indices of a shortest path in path order
+    NegativeCycleWitness negative_cycle_witness;
+};
+
+// sssp_targets solves sssp from src for the given targets only. The potential is found
+// as in sssp(), then the last dijkstra stops early: bidirectional for a single target,
+// and once every target is settled otherwise. No whole tree is built, so unlike sssp()
+// the answer is not validated. cfg.vertex_order and cfg.engine are ignored.
+// ws: optional scratch space, kept by the caller across calls.
+template <typename T, typename I>
+TargetPaths<T, I> sssp_targets(
+    Graph<T, I> &g,
+    size_t src,
+    const vector<size_t> &targets,
+    SSSPConfig &cfg,
+    Workspace<T, I> *ws = nullptr
+) {
+    TargetPaths<T, I> ret;
+
+    Graph<T, I> h(0);
+    auto wit = nonnegative_reweighting(g, h, cfg, ws);
+    if(wit.state != SHORTEST_PATH_TREE_FOUND) {
+        ret.state = wit.state;
+        ret.negative_cycle_witness = wit.negative_cycle_witness;
+        return ret;
+    }
+
+    ret.dist.assign(targets.size(), numeric_limits<T>::max());
+    ret.paths.resize(targets.size());
+
+    // distances are summed on g, as h has scaled weights.
+    auto set_path = [&](size_t i, vector<I> path) {
+        T d = T(0);
+        for(auto edge_idx : path) d += g.weight(edge_idx);
+        ret.dist[i] = d;
+        ret.paths[i] = move(path);
+    };
+
+    if(targets.size() == 1) {
+        auto [d, path] = bidirectional_dijkstra::single_target(h, src, targets[0], cfg.capper, ws);
+        if(d != numeric_limits<T>::max()) set_path(0, move(path));
+    } else {
+        Workspace<T, I> local_ws;
+        if(ws == nullptr) ws = &local_ws;
+        naive_dijkstra::multi_target(h, src, targets, *ws, cfg.capper);
+
+        for(size_t i = 0; i < targets.size(); i++) {
+            if(!ws->dist.has(targets[i])) continue;
+            vector<I> path;
+            for(size_t v = targets[i]; ws->parent_edge_idx.get(v) != I(-1); v = h.edges[path.back()].s) {
+                path.emplace_back(ws->parent_edge_idx.get(v));
+            }
+            reverse(path.begin(), path.end());
+            set_path(i, move(path));
+        }
+    }
+
+    if(cfg.capper -> fail()) return TargetPaths<T, I>();
+
+    ret.state = SHORTEST_PATH_TREE_FOUND;
+    return ret;
 }
\ No newline at end of file
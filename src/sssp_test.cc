@@ -1,6 +1,27 @@
 #include "sssp.hpp"
 #include "catch2/catch_all.hpp"
 
+// gen_forward makes a random DAG: m edges a -> b with a < b and weights in
+// [min_weight, 20], so it has no negative cycle.
+template <typename T = int, typename I = size_t>
+Graph<T, I> gen_forward(size_t n, size_t m, int min_weight, size_t seed) {
+    Graph<T, I> g(n);
+    mt19937 rng(seed);
+    uniform_int_distribution<int> v(0, int(n) - 1), wt(min_weight, 20);
+
+    for(size_t i = 0; i < m; i++) {
+        I a = v(rng), b = v(rng);
+        while(a == b) b = v(rng);
+        if(a > b) swap(a, b);
+        g.add_edge(Edge<T, I>({a, b, T(wt(rng))}));
+    }
+
+    return g;
+}
+
+// (n, seed) of the random instances every feature is checked on, with 3n / 2 edges.
+const vector<pair<size_t, size_t>> FORWARD_INSTANCES({{20, 0x4834}, {45, 0x51}, {120, 0x7e57}});
+
 TEST_CASE("test one-step scaler", "[sssp]") {
     Graph<int> g(20);
 
@@ -56,4 +77,244 @@ TEST_CASE("compare with bellman-ford", "[sssp]") {
 
     REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
     REQUIRE( wit.shortest_path_tree_witness.pure_dist == wit2.dist );
+}
+
+TEST_CASE("final dijkstra sees no negative weight", "[sssp]") {
+    // scaling stops at weights >= -3; the dijkstra after it must not meet them.
+    for(size_t seed = 1; seed <= 6; seed++) {
+        size_t n = 5 * seed;
+        Graph<int> g(n);
+
+        mt19937 rng(seed);
+        uniform_int_distribution<size_t> v(0, n - 1);
+        uniform_int_distribution<int> wt(-50, 20);
+
+        for(size_t i = 0; i < 2 * n; i++) {
+            size_t a = v(rng), b = v(rng);
+            while(a == b) b = v(rng);
+            if(a > b) swap(a, b);
+            g.add_edge(Edge<int>({a, b, wt(rng)}));
+        }
+
+        SSSPConfig cfg(size_t(-1));
+        auto wit = sssp(g, 0, cfg);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+}
+
+TEST_CASE("arbitrage cycle is reported", "[sssp]") {
+    Graph<int> g(5);
+
+    g.add_edge(Edge<int>({0, 1, 10}));
+    g.add_edge(Edge<int>({1, 2, -40}));
+    g.add_edge(Edge<int>({2, 3, 25}));
+    g.add_edge(Edge<int>({3, 1, 10}));
+    g.add_edge(Edge<int>({3, 4, -100}));
+
+    SSSPConfig cfg(60000);
+    auto wit = sssp(g, 0, cfg);
+
+    REQUIRE( wit.state == NEGATIVE_CYCLE_FOUND );
+    REQUIRE( wit.validate(g) );
+    REQUIRE_FALSE( cfg.capper -> fail() );
+}
+
+TEST_CASE("sssp with delta stepping engine", "[sssp]") {
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        Graph<int> g = gen_forward(n, 3 * n / 2, -300, seed);
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.engine = ENGINE_DELTA_STEPPING;
+        cfg.num_threads = 3;
+
+        auto wit = sssp(g, 0, cfg);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.validate(g) );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+}
+
+TEST_CASE("sssp with cached reduced weights", "[sssp]") {
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        Graph<int> g = gen_forward(n, 3 * n / 2, -300, seed);
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.cache_reduced_weights = true;
+
+        auto wit = sssp(g, 0, cfg);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+}
+
+TEST_CASE("sssp on a graph with 32-bit indices", "[sssp]") {
+    auto engine = GENERATE(ENGINE_DIJKSTRA, ENGINE_DELTA_STEPPING);
+
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        // the same graph with both index types.
+        Graph<int> g = gen_forward(n, 3 * n / 2, -300, seed);
+        Graph<int, uint32_t> h = gen_forward<int, uint32_t>(n, 3 * n / 2, -300, seed);
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.engine = engine;
+
+        auto wit = sssp(h, 0, cfg);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.validate(h) );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+
+        // negative cycle witnesses are edge indices of h.
+        h.add_edge(Edge<int, uint32_t>({uint32_t(n - 1), 0, -100000}));
+        SSSPConfig cfg2(size_t(-1));
+        auto cyc = sssp(h, 0, cfg2);
+
+        REQUIRE( cyc.state == NEGATIVE_CYCLE_FOUND );
+        REQUIRE( cyc.validate(h) );
+    }
+}
+
+TEST_CASE("targeted sssp agrees with bellman-ford", "[sssp]") {
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        Graph<int> g = gen_forward(n, 3 * n / 2, -300, seed);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        auto check = [&](const vector<size_t> &targets) {
+            SSSPConfig cfg(size_t(-1));
+            auto res = sssp_targets(g, 0, targets, cfg);
+            REQUIRE( res.state == SHORTEST_PATH_TREE_FOUND );
+
+            for(size_t i = 0; i < targets.size(); i++) {
+                REQUIRE( res.dist[i] == bf.dist[targets[i]] );
+
+                // the path runs from 0 to the target, with length dist.
+                size_t at = 0;
+                int len = 0;
+                for(auto edge_idx : res.paths[i]) {
+                    REQUIRE( g.edges[edge_idx].s == at );
+                    at = g.edges[edge_idx].e;
+                    len += g.weight(edge_idx);
+                }
+                if(res.dist[i] != numeric_limits<int>::max()) {
+                    REQUIRE( at == targets[i] );
+                    REQUIRE( len == res.dist[i] );
+                }
+            }
+        };
+
+        for(size_t t = 0; t < n; t++) check({t});
+        check({n - 1, 3, 7});
+        check({5, 5, 0, 12});
+    }
+}
+
+TEST_CASE("sssp restricted to the reachable part", "[sssp]") {
+    auto order = GENERATE(ORDER_NONE, ORDER_RCM);
+
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        // a random DAG on 0..n-1, and n..n+4 unreachable from 0, with a negative cycle.
+        Graph<int> g = gen_forward(n, 3 * n / 2, -300, seed);
+        for(size_t i = 0; i < 5; i++) g.add_vertex();
+        for(size_t a = n; a < n + 5; a++) g.add_edge(Edge<int>({a, a == n + 4 ? n : a + 1, -3}));
+        g.add_edge(Edge<int>({n + 2, 5, 1}));
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.prune_unreachable = true;
+        cfg.vertex_order = order;
+
+        auto wit = sssp(g, 0, cfg);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.validate(g) );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+        for(size_t x = n; x < n + 5; x++) REQUIRE( wit.shortest_path_tree_witness.dist[x] == numeric_limits<int>::max() );
+
+        // without pruning, the cycle is found from the virtual source.
+        SSSPConfig full(size_t(-1));
+        REQUIRE( sssp(g, 0, full).state == NEGATIVE_CYCLE_FOUND );
+    }
+}
+
+TEST_CASE("sssp with narrow weights", "[sssp]") {
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        // long cycles, none negative.
+        Graph<long long> g = gen_forward<long long>(n, 3 * n / 2, -300, seed);
+        for(size_t i = 0; i + 1 < n; i++) g.add_edge(Edge<long long>({i + 1, i, 6000}));
+
+        REQUIRE( internal::fits_weight_type<int32_t>(g) );
+        REQUIRE_FALSE( internal::fits_weight_type<int16_t>(g) );
+        REQUIRE_FALSE( internal::fits_weight_type<int64_t>(g) );
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.narrow_weights = true;
+
+        Workspace<long long> ws;
+        auto wit = sssp(g, 0, cfg, &ws);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+        // the scaling rounds ran on the caller's int32_t workspace.
+        REQUIRE( ws.narrow32 != nullptr );
+
+        // a negative cycle is found through the narrow copy as well.
+        g.add_edge(Edge<long long>({n - 1, 0, -30000}));
+        auto cyc = sssp(g, 0, cfg);
+        REQUIRE( cyc.state == NEGATIVE_CYCLE_FOUND );
+        REQUIRE( cyc.validate(g) );
+    }
+
+    // on small graphs, some rounds fit in int16_t.
+    for(size_t n : {6, 8, 10}) {
+        Graph<long long> g = gen_forward<long long>(n, 3 * n / 2, -60, n);
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.narrow_weights = true;
+
+        Workspace<long long> ws;
+        auto wit = sssp(g, 0, cfg, &ws);
+        REQUIRE( ws.narrow16 != nullptr );
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bellman_ford::single_source(g, 0).dist );
+    }
+}
+
+TEST_CASE("sssp with SCCs split first", "[sssp]") {
+    for(auto [n, seed] : FORWARD_INSTANCES) {
+        // a DAG of strongly connected blocks of 5 vertices, no negative cycle.
+        Graph<int> g = gen_forward(n, 3 * n / 2, -300, seed);
+        for(size_t i = 0; i + 1 < n; i++) {
+            if((i + 1) % 5 == 0) continue;
+            g.add_edge(Edge<int>({i, i + 1, 0}));
+            g.add_edge(Edge<int>({i + 1, i, 6000}));
+        }
+
+        SSSPConfig cfg(size_t(-1));
+        cfg.split_sccs_first = true;
+
+        auto wit = sssp(g, 0, cfg);
+        auto bf = bellman_ford::single_source(g, 0);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.validate(g) );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+        // the scaling rounds solved copies of g, and found its SCCs once for all of them.
+        REQUIRE( g.topology->filled );
+        REQUIRE( g.topology->num_scc == (n + 4) / 5 );
+
+        g.add_edge(Edge<int>({n - 1, 0, -100000}));
+        auto cyc = sssp(g, 0, cfg);
+        REQUIRE( cyc.state == NEGATIVE_CYCLE_FOUND );
+        REQUIRE( cyc.validate(g) );
+    }
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+// Scratch buffers kept by the caller across solver calls, so that repeated
+// queries pay neither allocations nor O(n) clearing for the parts they touch.
+#pragma once
+#include "spresult.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// StampedArray is an array with O(1) reset: a slot holds a value only if it was
+// written since the last reset, and reads as default_value otherwise.
+template <typename V>
+struct StampedArray {
+    vector<V> values;
+    vector<uint32_t> stamps;
+    uint32_t epoch = 1;
+    V default_value = V();
+
+    // forgets every value, and makes indices [0, n) valid.
+    void reset(size_t n, V value) {
+        default_value = value;
+        if(values.size() < n) {
+            values.resize(n);
+            stamps.resize(n, 0);
+        }
+        // on wrap-around, old stamps could match again: clear them once.
+        if(++epoch == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    bool has(size_t i) const { return stamps[i] == epoch; }
+
+    V get(size_t i) const { return has(i) ? values[i] : default_value; }
+
+    void set(size_t i, V value) {
+        values[i] = value;
+        stamps[i] = epoch;
+    }
+};
+
+// ReusableHeap is a min-heap over a borrowed vector, which keeps its capacity
+// between uses. Same interface as the priority_queue used by the solvers.
+template <typename PairT>
+struct ReusableHeap {
+    vector<PairT> &c;
+
+    ReusableHeap(vector<PairT> &buffer) : c(buffer) { c.clear(); }
+
+    bool empty() const { return c.empty(); }
+
+    size_t size() const { return c.size(); }
+
+    const PairT &top() const { return c.front(); }
+
+    void pop() {
+        pop_heap(c.begin(), c.end(), greater<PairT>());
+        c.pop_back();
+    }
+
+    template <typename... Args>
+    void emplace(Args &&...args) {
+        c.emplace_back(forward<Args>(args)...);
+        push_heap(c.begin(), c.end(), greater<PairT>());
+    }
+
+    // restores the heap order in O(size) after pushing to c directly.
+    void heapify() {
+        make_heap(c.begin(), c.end(), greater<PairT>());
+    }
+};
+
+// Workspace holds a sparse shortest path tree, a heap buffer and a scan list.
+// Call begin(n) before each query; it costs O(1), not O(n).
+template <typename T, typename I = size_t>
+struct Workspace {
+    StampedArray<T> dist;
+    StampedArray<I> parent_edge_idx;
+    vector<I> touched; // vertices whose dist was written since begin(), in first-write order
+    vector<pair<T, I>> heap;
+    vector<size_t> settled; // per-round scan list of lazy dijkstra
+
+    // transpose of the last top-level graph carved by rsssp, and that graph's topology.
+    // Scaling rounds carve copies of one graph, so they only refresh its weights.
+    Graph<T, I> transposed{0};
+    shared_ptr<GraphTopology<I>> transposed_topology;
+
+    // workspaces of solve_rsssp_narrow, one per weight type, made on first use.
+    unique_ptr<Workspace<int16_t, I>> narrow16;
+    unique_ptr<Workspace<int32_t, I>> narrow32;
+
+    template <typename N>
+    Workspace<N, I> &narrow() {
+        static_assert(is_same_v<N, int16_t> || is_same_v<N, int32_t>);
+        unique_ptr<Workspace<N, I>> *ws;
+        if constexpr(is_same_v<N, int16_t>) ws = &narrow16;
+        else ws = &narrow32;
+        if(*ws == nullptr) *ws = make_unique<Workspace<N, I>>();
+        return **ws;
+    }
+
+    void begin(size_t n) {
+        dist.reset(n, numeric_limits<T>::max());
+        parent_edge_idx.reset(n, I(-1));
+        touched.clear();
+    }
+
+    void set(size_t v, T d, I parent_edge) {
+        if(!dist.has(v)) touched.emplace_back(v);
+        dist.set(v, d);
+        parent_edge_idx.set(v, parent_edge);
+    }
+
+    // dense copy of the current tree, for APIs returning ShortestPathTreeWitnessV2.
+    ShortestPathTreeWitnessV2<T, I> witness(size_t n) const {
+        ShortestPathTreeWitnessV2<T, I> wit(n);
+        wit.dist.assign(n, numeric_limits<T>::max());
+        for(auto v : touched) {
+            wit.dist[v] = dist.get(v);
+            wit.parent_edge_idx[v] = parent_edge_idx.get(v);
+        }
+        return wit;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "workspace.hpp"
+#include "spalgo.hpp"
+#include "sssp.hpp"
+#include "catch2/catch_all.hpp"
+
+using namespace std;
+
+TEST_CASE("stamped array reset", "[workspace]") {
+    StampedArray<int> a;
+    a.reset(4, -1);
+    a.set(2, 7);
+
+    REQUIRE( a.get(2) == 7 );
+    REQUIRE( a.get(3) == -1 );
+
+    a.reset(6, -2);
+    REQUIRE_FALSE( a.has(2) );
+    REQUIRE( a.get(2) == -2 );
+    REQUIRE( a.get(5) == -2 );
+
+    // stamps are cleared when the epoch wraps around.
+    a.set(1, 3);
+    a.epoch = numeric_limits<uint32_t>::max();
+    a.stamps[0] = 1;
+    a.reset(6, 0);
+    REQUIRE( a.epoch == 1 );
+    REQUIRE_FALSE( a.has(0) );
+}
+
+TEST_CASE("sparse dijkstra reuses a workspace", "[workspace]") {
+    Graph<int> g(30);
+
+    mt19937 rng(0x51ab);
+    uniform_int_distribution<int> v(0, 29), wt(0, 40);
+    for(int i = 0; i < 60; i++) {
+        size_t a = v(rng), b = v(rng);
+        g.add_edge(Edge<int>({a, b, wt(rng)}));
+    }
+
+    Workspace<int> ws;
+    for(size_t src = 0; src < g.N(); src++) {
+        naive_dijkstra::multi_source_sparse(g, vector<size_t>({src}), false, ws);
+        auto expected = naive_dijkstra::single_source(g, src, false);
+
+        REQUIRE( ws.witness(g.N()).dist == expected.dist );
+        for(auto u : ws.touched) REQUIRE( ws.dist.get(u) != numeric_limits<int>::max() );
+    }
+}
+
+TEST_CASE("sssp with a workspace", "[workspace]") {
+    Graph<int> g(20);
+
+    mt19937 rng(0x4834);
+    uniform_int_distribution<int> v(0, 19), wt(-300, 20);
+
+    for(int i = 0; i < 30; i++) {
+        size_t a = v(rng), b = v(rng);
+        while(a == b) b = v(rng);
+        if(a > b) swap(a, b);
+
+        g.add_edge(Edge<int>({a, b, wt(rng)}));
+    }
+
+    Workspace<int> ws;
+    for(size_t src : {0, 5, 0}) {
+        SSSPConfig cfg(60000);
+        auto wit = sssp(g, src, cfg, &ws);
+        auto bf = bellman_ford::single_source(g, src);
+
+        REQUIRE( wit.state == SHORTEST_PATH_TREE_FOUND );
+        REQUIRE( wit.validate(g) );
+        REQUIRE( wit.shortest_path_tree_witness.pure_dist == bf.dist );
+    }
+}
\ No newline at end of file